@@ -0,0 +1,923 @@
+#include "core/simulation.h"
+
+#define BENCHMARK_ROUNDS 2000    // 效能測試重複次數
+#define BENCHMARK_SESSIONS 16    // 效能測試同時進行的無介面遊戲數
+#define BENCHMARK_SESSION_TICKS 100 // 效能測試每局遊戲進行的回合數
+#define BENCHMARK_HORDE_SIZE 64      // 多生存者效能測試一開始的喪屍數量
+#define BENCHMARK_SQUAD_ASTAR_TICKS 10 // 多生存者效能測試中 A* 進行的回合數，每位生存者每回合要數毫秒以上
+#define BENCHMARK_SEED 2023          // 效能測試的亂數種子
+#define BENCHMARK_MCTS_MS 200        // MCTS 效能測試每種執行緒數量搜尋的時間 (毫秒)
+
+// 執行效能測試
+void runBenchmarks(GameSession &session, GameField &field);
+
+// 比較 3x3 掃描與預先計算表的牆壁懲罰效能
+void benchmarkWallPenalty(GameSession &session, GameField &field);
+
+// 測試迷宮拓撲分析在大型地圖上的效能
+void benchmarkMazeTopology(GameSession &session, GameField &field);
+
+// 比較各指令集擴散核心的效能
+void benchmarkDiffusion(GameSession &session, GameField &field);
+
+#ifdef SURVIVAL_THREADS
+// 測量 MCTS 以 1 個與多個執行緒搜尋時每秒的模擬次數
+void benchmarkMcts(const GameField &field);
+#endif
+
+// 測試不同喪屍數量下每回合喪屍更新的效能
+void benchmarkZombieHorde(GameField &field);
+
+// 比較拒絕取樣與可放置格子索引挑選隨機格子的效能
+void benchmarkFreeCellIndex(GameSession &session, GameField &field);
+
+// 比較逐一掃描排序與資源索引找出最近資源的效能
+void benchmarkResourceIndex(GameField &field);
+
+// 比較逐格查詢與位元棋盤計算整個遊戲場的危險格子
+void benchmarkBitboards(GameField &field);
+
+// 比較大型地圖在不同排列方式下 BFS 與 A* 的效能，以及以快取模型估計的失誤率
+void benchmarkGridLayouts();
+
+// 生存者在無限地圖上持續往遠方移動，檢查常駐記憶體維持固定
+void benchmarkChunkedWorld();
+
+// 檢查無限地圖修改過的區塊被淘汰後會寫到磁碟，再次存取時讀回修改
+void benchmarkChunkPersistence();
+
+// 存放測試檔案的暫存資料夾
+std::string temporaryDirectory();
+
+// 以指定排列方式測試大型地圖 BFS 與 A*
+template<typename Layout>
+void benchmarkGridLayout(const std::vector<uint8_t> &walkable, int side);
+
+// 比較各指令集的格子計數、搜尋與遮罩核心
+void benchmarkCellScan(GameField &field);
+
+#ifdef SURVIVAL_THREADS
+// 測量以執行緒池同時進行多局無介面遊戲的回合吞吐量
+void benchmarkSessions(const GameField &field);
+#endif
+
+// 比較同一組樣板以編譯期規則與執行時規則實例化的效能，並以執行時規則跑任意大小的地圖
+void benchmarkRules(GameField &field);
+
+// 以預設的 A* 與共用擴散場的AI，測量 1、8、64 位生存者對抗大量喪屍時每回合的成本
+void benchmarkSurvivors(const GameField &field);
+
+#ifdef SURVIVAL_THREADS
+// 測量 Philox 亂數串流的速度，並檢查以執行緒池與單一執行緒進行同一組種子的遊戲結果完全相同
+void benchmarkReplay(const GameField &field);
+#endif
+
+// 整局遊戲狀態的雜湊值，用來比較兩次執行是否相同
+uint64_t sessionChecksum(const GameSession &session);
+
+// 以指定規則測試牆壁懲罰表與 BFS
+template<typename Rules>
+void benchmarkRulesCore(const Rules &rules, const uint8_t *cells, const char *name);
+
+// 以相同種子分別用預設規則與 setSessionRules 設定的規則進行遊戲
+void benchmarkSessionRules(const GameField &field);
+
+// 效能測試主程式
+int main() {
+    initInfluenceKernel();
+    initZobristKeys();
+
+    GameField field;
+    loadDefaultField(field);
+
+    // 效能測試不需要畫面，以無介面模式建立遊戲並固定亂數種子
+    std::unique_ptr<GameSession> sessionOwner(new GameSession());
+    GameSession &session = *sessionOwner;
+    initSession(session, field, BENCHMARK_SEED, true);
+
+    runBenchmarks(session, session.field);
+    return 0;
+}
+
+// 執行效能測試
+void runBenchmarks(GameSession &session, GameField &field) {
+    printf("== default map ==\n");
+    benchmarkWallPenalty(session, field);
+
+    generateMaze(session, field);
+    printf("== generated maze ==\n");
+    benchmarkWallPenalty(session, field);
+    benchmarkMazeTopology(session, field);
+    benchmarkDiffusion(session, field);
+#ifdef SURVIVAL_THREADS
+    benchmarkMcts(field);
+#endif
+    benchmarkZombieHorde(field);
+    benchmarkFreeCellIndex(session, field);
+    benchmarkResourceIndex(field);
+    benchmarkBitboards(field);
+    benchmarkGridLayouts();
+    benchmarkChunkedWorld();
+    benchmarkCellScan(field);
+#ifdef SURVIVAL_THREADS
+    benchmarkSessions(field);
+#endif
+    benchmarkRules(field);
+    benchmarkSurvivors(field);
+#ifdef SURVIVAL_THREADS
+    benchmarkReplay(field);
+#endif
+}
+
+// 比較 A* 內層迴圈中 3x3 掃描與預先計算表的牆壁懲罰效能
+void benchmarkWallPenalty(GameSession &session, GameField &field) {
+    using Clock = std::chrono::steady_clock;
+    long long checksumScan = 0, checksumTable = 0;
+    int lookups = 0;
+
+    auto begin = Clock::now();
+    for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+        for (int row = 1; row < GRID_SIDE - 1; row++) {
+            for (int col = 1; col < GRID_SIDE - 1; col++) {
+                if (!IsAtWall(field, row, col)) {
+                    checksumScan += scanWallPenalty(field, row, col);
+                    lookups++;
+                }
+            }
+        }
+    }
+    auto scanEnd = Clock::now();
+
+    buildWallPenaltyTable(session, field);
+    for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+        for (int row = 1; row < GRID_SIDE - 1; row++) {
+            for (int col = 1; col < GRID_SIDE - 1; col++) {
+                if (!IsAtWall(field, row, col)) {
+                    checksumTable += session.wallPenalty[row][col];
+                }
+            }
+        }
+    }
+    auto tableEnd = Clock::now();
+
+    // 每次迷宮生成只需建表一次
+    auto buildBegin = Clock::now();
+    for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+        invalidateWallPenaltyTable(session);
+        buildWallPenaltyTable(session, field);
+    }
+    auto buildEnd = Clock::now();
+
+    double scanNs = std::chrono::duration<double, std::nano>(scanEnd - begin).count() / lookups;
+    double tableNs = std::chrono::duration<double, std::nano>(tableEnd - scanEnd).count() / lookups;
+    double buildUs = std::chrono::duration<double, std::micro>(buildEnd - buildBegin).count() / BENCHMARK_ROUNDS;
+
+    printf("wall penalty 3x3 scan : %8.2f ns/lookup (checksum %lld)\n", scanNs, checksumScan);
+    printf("wall penalty table    : %8.2f ns/lookup (checksum %lld)\n", tableNs, checksumTable);
+    printf("wall penalty build    : %8.2f us/maze\n", buildUs);
+}
+
+// 測試迷宮拓撲分析在遊戲地圖與 1024x1024 隨機地圖上的效能
+void benchmarkMazeTopology(GameSession &session, GameField &field) {
+    using Clock = std::chrono::steady_clock;
+
+    auto begin = Clock::now();
+    for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+        buildMazeTopology(session, field);
+    }
+    double gameUs = std::chrono::duration<double, std::micro>(Clock::now() - begin).count() / BENCHMARK_ROUNDS;
+
+    int cutCount = 0, deadEndCount = 0;
+    for (int row = 0; row < GRID_SIDE; row++) {
+        for (int col = 0; col < GRID_SIDE; col++) {
+            cutCount += IsArticulationPoint(session, row, col);
+            deadEndCount += deadEndDepth(session, row, col) > 0;
+        }
+    }
+    printf("topology %4dx%-4d     : %8.2f us/pass (%d cut cells, %d dead-end cells)\n",
+           GRID_SIDE, GRID_SIDE, gameUs, cutCount, deadEndCount);
+    // 生成的迷宮一定有分支末端的死路，也有只靠一條通道連接的房間
+    if (cutCount == 0 || deadEndCount == 0)
+        printf("topology %4dx%-4d     : no cut cells or dead ends found in a generated maze\n", GRID_SIDE, GRID_SIDE);
+
+    const int side = 1024;
+    std::vector<uint8_t> walkable(side * side), topology(side * side);
+    std::mt19937 benchGenerator(2023);
+    for (auto &cell: walkable) {
+        cell = benchGenerator() % 100 >= 35;
+    }
+
+    begin = Clock::now();
+    analyzeMazeTopology(walkable.data(), side, side, topology.data());
+    double largeMs = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+
+    cutCount = 0;
+    deadEndCount = 0;
+    for (uint8_t cell: topology) {
+        cutCount += (cell & TOPOLOGY_CUT_BIT) != 0;
+        deadEndCount += (cell & TOPOLOGY_DEPTH_MASK) > 0;
+    }
+    printf("topology %4dx%-4d     : %8.2f ms/pass (%d cut cells, %d dead-end cells)\n",
+           side, side, largeMs, cutCount, deadEndCount);
+}
+
+#ifdef SURVIVAL_THREADS
+// 測量 MCTS 以 1 個與多個執行緒搜尋同一個局面時每秒的模擬次數，與 mctsAI 相同採用根平行化，
+// 每個執行緒各自建立搜尋樹；局面取自進行一段時間、已有喪屍的遊戲
+void benchmarkMcts(const GameField &field) {
+    using Clock = std::chrono::steady_clock;
+    std::unique_ptr<GameSession> owner(new GameSession());
+    GameSession &session = *owner;
+    initSession(session, field, BENCHMARK_SEED, true);
+    session.levelMode = false;
+    session.playerAIMode = AI_DIFFUSION;
+    generateMaze(session, session.field);
+    startGame(session);
+    for (int tick = 0; tick < BENCHMARK_SESSION_TICKS; tick++) {
+        if (stepGame(session) == STEP_CAUGHT)
+            startGame(session);
+    }
+    SimState root = makeSimState(session, session.field, &session.survivors[0], session.horde);
+
+    int manyThreads = std::min(std::max(4, int(std::thread::hardware_concurrency())), MCTS_MAX_THREADS);
+    for (int threadCount: {1, manyThreads}) {
+        std::vector<MctsResult> results(threadCount);
+        std::vector<std::thread> workers;
+        auto begin = Clock::now();
+        auto deadline = begin + std::chrono::milliseconds(BENCHMARK_MCTS_MS);
+        for (int i = 0; i < threadCount; i++) {
+            unsigned seed = unsigned(splitSeed(BENCHMARK_SEED, i));
+            workers.emplace_back([&results, &root, i, seed, deadline]() {
+                results[i] = runMctsWorker(root, seed, deadline, 0);
+            });
+        }
+        for (auto &worker: workers) {
+            worker.join();
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+        long long rollouts = 0;
+        for (const MctsResult &result: results) {
+            rollouts += result.rollouts;
+        }
+        printf("mcts %d threads       : %9.0f rollouts/s (%lld rollouts, %d zombies)\n",
+               threadCount, rollouts / seconds, rollouts, hordeSize(session.horde));
+    }
+}
+#endif
+
+// 比較各指令集擴散核心每回合 (DIFFUSION_ITERATIONS 次迭代) 的效能
+void benchmarkDiffusion(GameSession &session, GameField &field) {
+    using Clock = std::chrono::steady_clock;
+    const char *names[] = {"scalar", "sse", "avx2"};
+    DiffusionKernel kernels[] = {diffusionStepScalar, nullptr, nullptr};
+#ifdef DIFFUSION_SIMD
+    if (__builtin_cpu_supports("sse2"))
+        kernels[1] = diffusionStepSse;
+    if (__builtin_cpu_supports("avx2"))
+        kernels[2] = diffusionStepAvx2;
+#endif
+
+    buildDiffusionMask(session, field);
+    DiffusionKernel selected = diffusionStep;
+    for (int i = 0; i < 3; i++) {
+        if (kernels[i] == nullptr) {
+            printf("diffusion %-12s: not supported\n", names[i]);
+            continue;
+        }
+
+        diffusionStep = kernels[i];
+        resetScentField(session.resourceScent);
+        addScentSource(session.resourceScent, GRID_SIDE / 2, GRID_SIDE / 2, RESOURCE_SCENT);
+        auto begin = Clock::now();
+        for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+            diffuseScent(session, session.resourceScent);
+        }
+        double tickUs = std::chrono::duration<double, std::micro>(Clock::now() - begin).count() / BENCHMARK_ROUNDS;
+
+        float checksum = 0.0f;
+        for (float value: session.resourceScent.value[session.resourceScent.current]) {
+            checksum += value;
+        }
+        printf("diffusion %-12s: %8.2f us/field/tick (checksum %.3f)\n", names[i], tickUs, checksum);
+    }
+    diffusionStep = selected;
+}
+
+// 測試每回合喪屍更新的效能：所有喪屍決定簡化方向、更新位置，並做生存者周圍的碰撞查詢
+// 喪屍數量遠超過空格數時允許重疊，只用來觀察喪屍群的擴充性
+void benchmarkZombieHorde(GameField &field) {
+    using Clock = std::chrono::steady_clock;
+    const int counts[] = {10, 1000, 50000};
+    const int ticks = 100;
+    Entity player = {GRID_SIDE / 2, GRID_SIDE / 2, RIGHT, nullptr, false};
+
+    for (int count: counts) {
+        ZombieHorde horde;
+        std::mt19937 placement(count);
+        while (hordeSize(horde) < count) {
+            int row = int(placement() % GRID_SIDE);
+            int col = int(placement() % GRID_SIDE);
+            if (!IsAtWall(field, row, col))
+                spawnZombie(horde, row, col, RIGHT);
+        }
+
+        int caught = 0;
+        auto begin = Clock::now();
+        for (int tick = 0; tick < ticks; tick++) {
+            for (int index = 0; index < count; index++) {
+                Location target = {player.row + index * 2, player.col + index * 2};
+                horde.direct[index] = greedyZombieDirect(field, horde, index, target);
+            }
+            advanceZombies(horde);
+            caught += IsCloseZombie(horde, player.row, player.col);
+        }
+        double tickUs = std::chrono::duration<double, std::micro>(Clock::now() - begin).count() / ticks;
+
+        printf("zombie horde %6d: %10.2f us/tick %8.2f ns/zombie (caught %d)\n",
+               count, tickUs, tickUs * 1000.0 / count, caught);
+    }
+}
+
+// 比較拒絕取樣與可放置格子索引挑選隨機格子的效能，先放入一群喪屍讓可用格子變少
+void benchmarkFreeCellIndex(GameSession &session, GameField &field) {
+    using Clock = std::chrono::steady_clock;
+    const int picks = BENCHMARK_ROUNDS * 100;
+    FreeCellIndex index;
+    ZombieHorde horde;
+    horde.freeCells = &index;
+    buildFreeCellIndex(index, field, horde);
+    Entity player = {1, 1, RIGHT, nullptr, false};
+    spawnZombieWave(session, horde, &player, 1, int(index.cells.size()) / 2, RIGHT);
+
+    long long checksum = 0, tries = 0;
+    auto begin = Clock::now();
+    for (int i = 0; i < picks; i++) {
+        int row, col;
+        do {
+            row = randomBelow(session.random[RANDOM_RESOURCE], GRID_SIDE);
+            col = randomBelow(session.random[RANDOM_RESOURCE], GRID_SIDE);
+            tries++;
+        } while (IsAtWall(field, row, col) || IsAtZombie(horde, row, col));
+        checksum += row * GRID_SIDE + col;
+    }
+    double rejectionNs = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / picks;
+
+    begin = Clock::now();
+    for (int i = 0; i < picks; i++) {
+        checksum += randomFreeCell(session.random[RANDOM_RESOURCE], index);
+    }
+    double indexNs = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / picks;
+
+    printf("free cell rejection : %8.2f ns/pick (%.1f tries/pick, %d free cells)\n",
+           rejectionNs, double(tries) / picks, int(index.cells.size()));
+    printf("free cell index     : %8.2f ns/pick (checksum %lld)\n", indexNs, checksum);
+}
+
+// 比較 evalBestLocation 取得候選資源的兩種方式：第 1 到第 MAX_EVAL_PATH 近各掃描排序一次，或資源索引查詢一次
+void benchmarkResourceIndex(GameField &field) {
+    using Clock = std::chrono::steady_clock;
+    const int queries = BENCHMARK_ROUNDS;
+    const int resourceCounts[] = {5, 50};
+
+    for (int resources: resourceCounts) {
+        GameField copy = field;
+        std::mt19937 placement(resources);
+        for (int placed = 0; placed < resources;) {
+            int row = int(placement() % GRID_SIDE);
+            int col = int(placement() % GRID_SIDE);
+            if (copy[row][col] == EMPTY) {
+                setFieldCell(copy, row, col, RESOURCE);
+                placed++;
+            }
+        }
+        ResourceIndex index;
+        buildResourceIndex(index, copy);
+
+        std::vector<Entity> queryFrom;
+        for (int i = 0; i < queries; i++) {
+            queryFrom.push_back({int(placement() % GRID_SIDE), int(placement() % GRID_SIDE), RIGHT, nullptr, false});
+        }
+
+        long long checksumScan = 0, checksumIndex = 0;
+        auto begin = Clock::now();
+        for (Entity &me: queryFrom) {
+            for (int k = 1; k <= MAX_EVAL_PATH; k++) {
+                Location resource = findNearestKthResource(copy, &me, k);
+                if (resource.row != -1)
+                    checksumScan += calculateDistance(me.row, me.col, resource.row, resource.col);
+            }
+        }
+        double scanUs = std::chrono::duration<double, std::micro>(Clock::now() - begin).count() / queries;
+
+        std::vector<Location> nearest;
+        begin = Clock::now();
+        for (Entity &me: queryFrom) {
+            findNearestResources(index, Location{me.row, me.col}, MAX_EVAL_PATH, nearest);
+            for (Location resource: nearest) {
+                checksumIndex += calculateDistance(me.row, me.col, resource.row, resource.col);
+            }
+        }
+        double indexUs = std::chrono::duration<double, std::micro>(Clock::now() - begin).count() / queries;
+
+        printf("nearest %2d resources: scan %8.2f us, index %6.2f us (checksum %lld / %lld)\n",
+               resources, scanUs, indexUs, checksumScan, checksumIndex);
+    }
+}
+
+// 比較逐格查詢與位元棋盤計算整個遊戲場中「不是牆也不靠近喪屍」的格子數量
+void benchmarkBitboards(GameField &field) {
+    using Clock = std::chrono::steady_clock;
+    ZombieHorde horde;
+    std::mt19937 placement(39);
+    while (hordeSize(horde) < 50) {
+        int row = int(placement() % GRID_SIDE);
+        int col = int(placement() % GRID_SIDE);
+        if (!IsAtWall(field, row, col))
+            spawnZombie(horde, row, col, RIGHT);
+    }
+    GameBitboards bits;
+    fieldToBitboards(field, horde, nullptr, bits);
+
+    long long checksumCells = 0, checksumBits = 0;
+    auto begin = Clock::now();
+    for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+        for (int row = 0; row < GRID_SIDE; row++) {
+            for (int col = 0; col < GRID_SIDE; col++) {
+                checksumCells += !IsAtWall(field, row, col) && !IsCloseZombie(horde, row, col);
+            }
+        }
+    }
+    double cellsUs = std::chrono::duration<double, std::micro>(Clock::now() - begin).count() / BENCHMARK_ROUNDS;
+
+    begin = Clock::now();
+    for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+        BitBoard blocked = bitboardOr(bits.wall, zombieDanger(horde));
+        checksumBits += GRID_SIDE * GRID_SIDE - bitboardCount(blocked);
+    }
+    double bitsUs = std::chrono::duration<double, std::micro>(Clock::now() - begin).count() / BENCHMARK_ROUNDS;
+
+    printf("safe cells per cell  : %8.3f us/board (checksum %lld)\n", cellsUs, checksumCells);
+    printf("safe cells bitboard  : %8.3f us/board (checksum %lld)\n", bitsUs, checksumBits);
+}
+
+// 比較大型地圖在列優先、Morton 與 8x8 分塊排列下 BFS 與 A* 的效能，以及快取模型估計的失誤率
+void benchmarkGridLayouts() {
+    const int sides[] = {256, 1024, 4096};
+    std::mt19937 benchGenerator(41);
+
+    for (int side: sides) {
+        // Morton 排列要求邊長是 2 的次方 (最多 65536)，分塊排列要求是 GRID_TILE_SIDE 的倍數，否則索引會超出範圍
+        if ((side & (side - 1)) != 0 || side > 65536 || side % GRID_TILE_SIDE != 0) {
+            printf("grid side %d is not a power of two and a multiple of %d, skipped\n", side, GRID_TILE_SIDE);
+            continue;
+        }
+
+        std::vector<uint8_t> walkable(int64_t(side) * side);
+        for (auto &cell: walkable) {
+            cell = benchGenerator() % 100 >= 30;
+        }
+
+        benchmarkGridLayout<RowMajorLayout>(walkable, side);
+        benchmarkGridLayout<MortonLayout>(walkable, side);
+        benchmarkGridLayout<TiledLayout>(walkable, side);
+    }
+}
+
+// 以指定排列方式從地圖中央做一次完整 BFS，再往左上角做一次 A*，計時與快取模型分開各跑一次
+template<typename Layout>
+void benchmarkGridLayout(const std::vector<uint8_t> &walkable, int side) {
+    using Clock = std::chrono::steady_clock;
+    LayoutGrid<Layout> grid;
+    buildLayoutGrid(grid, walkable, side);
+    std::vector<int> distance;
+    Location start = {side / 2, side / 2};
+    while (!isGridWalkable(grid, start.row, start.col)) {
+        start.col++;
+    }
+
+    auto begin = Clock::now();
+    long long expanded = gridBreadthFirst(grid, start, distance, nullptr);
+    double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+    long long checksum = 0;
+    for (int value: distance) {
+        checksum += value;
+    }
+
+    CacheModel cache;
+    resetCacheModel(cache);
+    gridBreadthFirst(grid, start, distance, &cache);
+
+    printf("bfs   %4dx%-4d %-9s: %7.2f M expansions/s, %5.1f%% modeled misses (checksum %lld)\n",
+           side, side, Layout::name(), expanded / seconds / 1e6,
+           100.0 * cache.misses / std::max(cache.accesses, 1LL), checksum);
+
+    // A* 的終點取左上角附近第一個 BFS 走得到的格子，路徑會跨過大半張地圖
+    Location goal = {side / 8, side / 8};
+    while (distance[Layout::index(goal.row, goal.col, side)] == -1) {
+        goal.col++;
+    }
+
+    begin = Clock::now();
+    expanded = gridAStar(grid, start, goal, distance, nullptr);
+    seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    int pathLength = distance[Layout::index(goal.row, goal.col, side)];
+
+    resetCacheModel(cache);
+    gridAStar(grid, start, goal, distance, &cache);
+
+    printf("astar %4dx%-4d %-9s: %7.2f M expansions/s, %5.1f%% modeled misses (path %d)\n",
+           side, side, Layout::name(), expanded / seconds / 1e6,
+           100.0 * cache.misses / std::max(cache.accesses, 1LL), pathLength);
+}
+
+// 生存者在無限地圖上一段一段往東南方走，每段以 A* 跨區塊搜尋，常駐區塊數應維持在上限內
+void benchmarkChunkedWorld() {
+    using Clock = std::chrono::steady_clock;
+    const int legs = 40;
+    const int legLength = 150;
+    ChunkedWorld world;
+    initChunkedWorld(world, 2023, WORLD_CHUNK_BUDGET, "");
+    std::vector<WorldLocation> path;
+    WorldLocation survivor = {1, 1};
+    long long steps = 0;
+    int failed = 0;
+    size_t peakChunks = 0;
+
+    auto begin = Clock::now();
+    for (int leg = 0; leg < legs; leg++) {
+        // 目標是遠方最近的通道格
+        WorldLocation goal = {survivor.row + legLength, survivor.col + legLength};
+        while (worldCell(world, goal) == WALL) {
+            goal.col++;
+        }
+
+        if (findWorldPath(world, survivor, goal, path)) {
+            steps += int64_t(path.size()) - 1;
+            survivor = goal;
+        } else {
+            failed++;
+        }
+        peakChunks = std::max(peakChunks, world.chunks.size());
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+    printf("chunked world: %lld steps to (%lld, %lld) in %.2f ms, %d failed legs\n",
+           steps, (long long) survivor.row, (long long) survivor.col, seconds * 1e3, failed);
+    printf("chunked world: peak %zu resident chunks (%zu KB), %lld generated, %lld evicted\n",
+           peakChunks, peakChunks * sizeof(WorldChunk) / 1024, world.generated, world.evicted);
+
+    benchmarkChunkPersistence();
+}
+
+// 修改區塊 (0, 0) 的一格後走到遠方讓它被淘汰，再次存取時應從磁碟讀回修改，複製到遊戲區域也看得到
+void benchmarkChunkPersistence() {
+    const int budget = 4;
+    ChunkedWorld world;
+    initChunkedWorld(world, 2023, budget, temporaryDirectory());
+    WorldLocation edited = {1, 1};
+    uint8_t value = worldCell(world, edited) == WALL ? 0 : WALL;
+    setWorldCell(world, edited, value);
+
+    for (int i = 1; i <= budget; i++) {
+        worldCell(world, {0, int64_t(i) * CHUNK_SIDE});
+    }
+    bool evicted = world.chunkSlot.find(chunkKey(0, 0)) == world.chunkSlot.end();
+
+    bool reloaded = worldCell(world, edited) == value && world.loaded == 1;
+    std::unique_ptr<GameField> field(new GameField());
+    copyWorldWindow(world, {0, 0}, *field);
+    bool copied = IsAtWall(*field, int(edited.row), int(edited.col)) == (value == WALL);
+    std::remove(worldChunkPath(world, 0, 0).c_str());
+
+    printf("chunked world: edited chunk %s, %s from %s, %s in the field window\n",
+           evicted ? "evicted" : "NOT evicted", reloaded ? "reloaded" : "NOT reloaded",
+           world.directory.c_str(), copied ? "visible" : "NOT visible");
+}
+
+// 存放測試檔案的暫存資料夾，依序查看 TMPDIR、TEMP、TMP 環境變數
+std::string temporaryDirectory() {
+    for (const char *name: {"TMPDIR", "TEMP", "TMP"}) {
+        const char *directory = getenv(name);
+        if (directory && *directory)
+            return directory;
+    }
+    return "/tmp";
+}
+
+// 比較各指令集的格子掃描核心：計算資源數、以搜尋逐一找出所有資源、產生牆壁遮罩，各核心的結果都應相同
+void benchmarkCellScan(GameField &field) {
+    using Clock = std::chrono::steady_clock;
+    CellScanKernels kernels[] = {
+            {"scalar", countCellsScalar, findCellScalar, maskCellsScalar},
+            {"sse2", nullptr, nullptr, nullptr},
+            {"avx2", nullptr, nullptr, nullptr},
+            {"avx512", nullptr, nullptr, nullptr},
+    };
+#ifdef CELL_SCAN_SIMD
+    if (__builtin_cpu_supports("sse2"))
+        kernels[1] = {"sse2", countCellsSse2, findCellSse2, maskCellsSse2};
+    if (__builtin_cpu_supports("avx2"))
+        kernels[2] = {"avx2", countCellsAvx2, findCellAvx2, maskCellsAvx2};
+    if (__builtin_cpu_supports("avx512bw"))
+        kernels[3] = {"avx512", countCellsAvx512, findCellAvx512, maskCellsAvx512};
+#endif
+
+    // 放一些資源讓計數與搜尋有東西可找
+    GameField copy = field;
+    std::mt19937 placement(44);
+    for (int placed = 0; placed < 50;) {
+        int row = int(placement() % GRID_SIDE);
+        int col = int(placement() % GRID_SIDE);
+        if (copy[row][col] == EMPTY) {
+            setFieldCell(copy, row, col, RESOURCE);
+            placed++;
+        }
+    }
+
+    for (const CellScanKernels &kernel: kernels) {
+        if (kernel.count == nullptr) {
+            printf("cell scan %-7s: not supported\n", kernel.name);
+            continue;
+        }
+
+        long long counted = 0;
+        auto begin = Clock::now();
+        for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+            counted += kernel.count(copy.cells, FIELD_SIZE, RESOURCE);
+        }
+        auto countEnd = Clock::now();
+
+        long long found = 0;
+        for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+            for (int cell = 0; cell < FIELD_SIZE; cell++) {
+                cell += kernel.find(copy.cells + cell, FIELD_SIZE - cell, RESOURCE);
+                found += cell < FIELD_SIZE;
+            }
+        }
+        auto findEnd = Clock::now();
+
+        long long masked = 0;
+        uint64_t bits[FIELD_MASK_WORDS];
+        for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+            kernel.mask(copy.cells, FIELD_SIZE, WALL, bits);
+            for (uint64_t word: bits) {
+                masked += __builtin_popcountll(word);
+            }
+        }
+        auto maskEnd = Clock::now();
+
+        double countNs = std::chrono::duration<double, std::nano>(countEnd - begin).count() / BENCHMARK_ROUNDS;
+        double findNs = std::chrono::duration<double, std::nano>(findEnd - countEnd).count() / BENCHMARK_ROUNDS;
+        double maskNs = std::chrono::duration<double, std::nano>(maskEnd - findEnd).count() / BENCHMARK_ROUNDS;
+        printf("cell scan %-7s: count %7.1f ns, find all %8.1f ns, mask %7.1f ns (checksum %lld / %lld / %lld)\n",
+               kernel.name, countNs, findNs, maskNs, counted, found, masked);
+    }
+}
+
+#ifdef SURVIVAL_THREADS
+// 測量以執行緒池同時進行多局無介面遊戲的回合吞吐量
+void benchmarkSessions(const GameField &field) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<std::unique_ptr<GameSession>> sessions;
+    for (int i = 0; i < BENCHMARK_SESSIONS; i++) {
+        sessions.emplace_back(new GameSession());
+        initSession(*sessions.back(), field, splitSeed(BENCHMARK_SEED, i), true);
+        startGame(*sessions.back());
+    }
+
+    // 比較單一工作執行緒與所有核心的吞吐量
+    std::vector<int> threadCounts = {1};
+    if (std::thread::hardware_concurrency() > 1)
+        threadCounts.push_back(int(std::thread::hardware_concurrency()));
+    for (int threadCount: threadCounts) {
+        ThreadPool pool;
+        startThreadPool(pool, threadCount);
+        std::vector<StepResult> results;
+        int finished = 0;
+
+        auto begin = Clock::now();
+        for (int tick = 0; tick < BENCHMARK_SESSION_TICKS; tick++) {
+            stepSessions(pool, sessions, results);
+            for (StepResult result: results) {
+                finished += result != STEP_RUNNING;
+            }
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+        stopThreadPool(pool);
+
+        long long scores = 0;
+        for (auto &session: sessions) {
+            scores += session->scoreSum;
+        }
+        printf("sessions %2d threads: %d games x %d ticks in %7.1f ms, %9.0f ticks/s (finished %d, score %lld)\n",
+               threadCount, BENCHMARK_SESSIONS, BENCHMARK_SESSION_TICKS, seconds * 1000,
+               BENCHMARK_SESSIONS * BENCHMARK_SESSION_TICKS / seconds, finished, scores);
+    }
+}
+#endif
+
+// 比較同一組樣板以編譯期規則與執行時規則實例化的效能，並以執行時規則跑任意大小的地圖
+void benchmarkRules(GameField &field) {
+    RuntimeRules runtime;
+    benchmarkRulesCore(ClassicRules(), field.cells, "classic 40");
+    benchmarkRulesCore(runtime, field.cells, "runtime 40");
+
+    // 任意大小的地圖：外圈為哨兵牆，內部約 1/4 是牆
+    std::mt19937 random(BENCHMARK_ROUNDS);
+    for (int side: {64, 256}) {
+        runtime.sideValue = side;
+        std::vector<uint8_t> cells(runtime.stride() * runtime.stride(), WALL);
+        for (int row = 0; row < side; row++) {
+            for (int col = 0; col < side; col++) {
+                cells[rulesCellIndex(runtime, row, col)] = random() % 4 == 0 ? WALL : EMPTY;
+            }
+        }
+        cells[rulesCellIndex(runtime, 1, 2)] = EMPTY;
+        char name[32];
+        sprintf(name, "runtime %d", side);
+        benchmarkRulesCore(runtime, cells.data(), name);
+    }
+
+    benchmarkSessionRules(field);
+}
+
+// 以相同種子分別用預設規則與 setSessionRules 設定的規則進行遊戲，比較每回合成本與牆壁懲罰表
+void benchmarkSessionRules(const GameField &field) {
+    using Clock = std::chrono::steady_clock;
+    RuntimeRules custom;
+    custom.maxEvalPathValue = 3;
+    custom.wallPenaltyThresholdValue = 1;
+    custom.zombieMoveIntervalValue = 3;
+
+    for (bool useCustom: {false, true}) {
+        std::unique_ptr<GameSession> owner(new GameSession());
+        GameSession &session = *owner;
+        initSession(session, field, BENCHMARK_SEED, true);
+        session.levelMode = false;
+        if (useCustom && !setSessionRules(session, custom))
+            printf("setSessionRules rejected the rules\n");
+        generateMaze(session, session.field);
+        startGame(session);
+
+        int games = 1;
+        auto begin = Clock::now();
+        for (int tick = 0; tick < BENCHMARK_SESSION_TICKS; tick++) {
+            if (stepGame(session) == STEP_CAUGHT) {
+                startGame(session);
+                games++;
+            }
+        }
+        double tickUs = std::chrono::duration<double, std::micro>(Clock::now() - begin).count() / BENCHMARK_SESSION_TICKS;
+
+        long long penaltySum = 0;
+        for (int row = 0; row < GRID_SIDE; row++) {
+            for (int col = 0; col < GRID_SIDE; col++) {
+                penaltySum += session.wallPenalty[row][col];
+            }
+        }
+        printf("session %-7s rules: %9.1f us/tick (games %d, score %d, wall penalty sum %lld)\n",
+               useCustom ? "custom" : "classic", tickUs, games, session.scoreSum, penaltySum);
+    }
+}
+
+// 測量 1、8、64 位生存者對抗大量喪屍時每回合的成本，全部死亡時重新開始
+// 預設的 A* 每位生存者各自搜尋，擴散場的AI共用每回合建立一次的氣味場，兩種都測量才看得出共用規劃的效果
+void benchmarkSurvivors(const GameField &field) {
+    using Clock = std::chrono::steady_clock;
+    for (PlayerAIMode mode: {AI_PATH_SEARCH, AI_DIFFUSION}) {
+        for (int squadSize: {1, 8, 64}) {
+            std::unique_ptr<GameSession> owner(new GameSession());
+            GameSession &session = *owner;
+            initSession(session, field, splitSeed(BENCHMARK_SEED, squadSize), true);
+            session.squadSize = squadSize;
+            session.levelMode = false;
+            session.playerAIMode = mode;
+
+            int ticks = mode == AI_PATH_SEARCH ? BENCHMARK_SQUAD_ASTAR_TICKS : BENCHMARK_SESSION_TICKS;
+            long long survivorTicks = 0;
+            int restarts = 0;
+            double seconds = 0;
+            for (int tick = 0; tick < ticks; tick++) {
+                if (tick == 0 || session.survivors.empty()) {
+                    startGame(session);
+                    spawnZombieWave(session, session.horde, session.survivors.data(), int(session.survivors.size()),
+                                    BENCHMARK_HORDE_SIZE - 1, RIGHT);
+                    restarts++;
+                }
+                survivorTicks += int(session.survivors.size());
+                auto begin = Clock::now();
+                stepGame(session);
+                seconds += std::chrono::duration<double>(Clock::now() - begin).count();
+            }
+
+            // 喪屍規劃受 aiTickBudget 限制，與生存者數量無關，生存者決策的時間另外統計才看得出生存者的擴展性
+            double tickUs = seconds * 1e6 / ticks;
+            double planUs = session.survivorPlanNs / 1e3;
+            printf("survivors %2d %-7s: %9.1f us/tick, survivor planning %8.1f us/tick, %7.1f us/survivor tick "
+                   "(avg alive %.1f, games %d, score %d)\n",
+                   squadSize, aiModeNames[mode], tickUs, planUs / ticks,
+                   planUs / std::max(survivorTicks, 1LL),
+                   double(survivorTicks) / ticks, restarts, session.scoreSum);
+        }
+    }
+}
+
+// 以指定規則測試牆壁懲罰表與從生存者起點開始的 BFS
+template<typename Rules>
+void benchmarkRulesCore(const Rules &rules, const uint8_t *cells, const char *name) {
+    using Clock = std::chrono::steady_clock;
+    const int side = rules.side();
+    const int stride = rules.stride();
+    const int rounds = std::max(1, BENCHMARK_ROUNDS * GRID_SIDE * GRID_SIDE / (side * side));
+    std::vector<int> wallCount(side * side), wallPenalty(side * side);
+    std::vector<int> distance(stride * stride), queue(stride * stride);
+    int source = rulesCellIndex(rules, 1, 2);
+    long long checksumTable = 0, checksumSearch = 0;
+
+    auto begin = Clock::now();
+    for (int round = 0; round < rounds; round++) {
+        buildRulesWallTable(rules, cells, wallCount.data(), wallPenalty.data());
+        checksumTable += wallPenalty[round % (side * side)];
+    }
+    auto tableEnd = Clock::now();
+    for (int round = 0; round < rounds; round++) {
+        checksumSearch += rulesBreadthFirst(rules, cells, &source, 1, distance.data(), nullptr, queue.data());
+    }
+    auto searchEnd = Clock::now();
+
+    double tableNs = std::chrono::duration<double, std::nano>(tableEnd - begin).count() / rounds;
+    double searchNs = std::chrono::duration<double, std::nano>(searchEnd - tableEnd).count() / rounds;
+    printf("rules %-11s: wall table %9.1f ns (%5.2f ns/cell), BFS %9.1f ns (%5.2f ns/cell) (checksum %lld / %lld)\n",
+           name, tableNs, tableNs / (side * side), searchNs, searchNs / (side * side), checksumTable, checksumSearch);
+}
+
+#ifdef SURVIVAL_THREADS
+// 測量 Philox 亂數串流的速度，並以相同的種子分別用所有核心與單一執行緒進行多局遊戲，比較每局的結果
+void benchmarkReplay(const GameField &field) {
+    using Clock = std::chrono::steady_clock;
+    RandomStream random;
+    seedRandomStream(random, BENCHMARK_SEED, 0);
+    uint64_t checksumRandom = 0;
+    auto begin = Clock::now();
+    for (int i = 0; i < BENCHMARK_ROUNDS * 100; i++) {
+        checksumRandom += nextRandom(random);
+    }
+    double randomNs = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / (BENCHMARK_ROUNDS * 100);
+    printf("random philox      : %8.2f ns/number (checksum %llu)\n", randomNs, (unsigned long long) checksumRandom);
+
+    std::vector<int> threadCounts = {std::max(4, int(std::thread::hardware_concurrency())), 1};
+    std::vector<std::vector<uint64_t>> checksums;
+    for (int threadCount: threadCounts) {
+        std::vector<std::unique_ptr<GameSession>> sessions;
+        for (int i = 0; i < BENCHMARK_SESSIONS; i++) {
+            sessions.emplace_back(new GameSession());
+            GameSession &session = *sessions.back();
+            initSession(session, field, splitSeed(BENCHMARK_SEED, i), true);
+            session.deterministic = true;  // 時間預算會讓結果隨機器速度改變，重播時改用固定的工作量
+            generateMaze(session, session.field);
+            startGame(session);
+        }
+
+        ThreadPool pool;
+        startThreadPool(pool, threadCount);
+        std::vector<StepResult> results;
+        for (int tick = 0; tick < BENCHMARK_SESSION_TICKS; tick++) {
+            stepSessions(pool, sessions, results);
+        }
+        stopThreadPool(pool);
+
+        checksums.emplace_back();
+        for (auto &session: sessions) {
+            checksums.back().push_back(sessionChecksum(*session));
+        }
+    }
+    int identical = 0;
+    for (int i = 0; i < BENCHMARK_SESSIONS; i++) {
+        identical += checksums[0][i] == checksums[1][i];
+    }
+    printf("replay %2d threads vs 1: %d / %d games identical after %d ticks\n",
+           threadCounts[0], identical, BENCHMARK_SESSIONS, BENCHMARK_SESSION_TICKS);
+}
+#endif
+
+// 以 FNV-1a 雜湊遊戲場、生存者、喪屍與分數
+uint64_t sessionChecksum(const GameSession &session) {
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](uint64_t value) {
+        hash = (hash ^ value) * 1099511628211ULL;
+    };
+    for (uint8_t cell: session.field.cells) {
+        mix(cell);
+    }
+    for (const Entity &survivor: session.survivors) {
+        mix(uint64_t(survivor.row) << 32 | uint32_t(survivor.col));
+    }
+    for (int i = 0; i < hordeSize(session.horde); i++) {
+        mix(uint64_t(session.horde.row[i]) << 32 | uint32_t(session.horde.col[i]));
+    }
+    mix(uint64_t(session.scoreSum));
+    mix(uint64_t(session.level));
+    return hash;
+}
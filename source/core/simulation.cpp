@@ -0,0 +1,3502 @@
+#include "core/simulation.h"
+
+// 依指定規則進行一個回合
+template<typename Rules>
+StepResult stepGameWithRules(GameSession &session, const Rules &rules);
+
+// 模擬喪屍AI下一步的共用實作，isWall 判斷該格是否為牆
+template<typename WallTest>
+void greedyZombieStep(WallTest isWall, int &row, int &col, Location target);
+
+// 以下為所有遊戲共用、啟動後只會讀取的設定與表格，每局遊戲各自的狀態在 GameSession 中
+int const scorePerResource = 1;    // 每一份資源可得分數
+int const zombieLodRange = ZOMBIE_LOD_RANGE;       // 遠方喪屍的距離門檻
+int const zombieLodInterval = ZOMBIE_LOD_INTERVAL; // 遠方喪屍重新規劃的間隔
+int const aiTickBudget = AI_TICK_BUDGET_US;        // 每回合喪屍規劃的時間預算
+const char *aiModeNames[AI_MODE_COUNT] = {"A*", "Scent", "Expecti", "MCTS"}; // 生存者AI種類名稱
+
+int influenceKernel[INFLUENCE_KERNEL_SIZE][INFLUENCE_KERNEL_SIZE]; // 單一喪屍的影響核心
+DiffusionKernel diffusionStep = selectDiffusionKernel(); // 執行時選擇的擴散核心
+CellScanKernels cellScan = selectCellScanKernels();      // 執行時選擇的格子掃描核心
+
+uint64_t zobristPlayer[GRID_SIDE * GRID_SIDE];   // 生存者在各格的雜湊值
+uint64_t zobristZombie[GRID_SIDE * GRID_SIDE];   // 喪屍在各格的雜湊值
+uint64_t zobristResource[GRID_SIDE * GRID_SIDE]; // 資源在各格的雜湊值，被收集時切換
+uint64_t zobristZombieTurn;                      // 喪屍這回合會移動時切換的雜湊值
+
+// 載入預設的遊戲場和障礙物
+void loadDefaultField(GameField &field) {
+    static const int fieldMap[GRID_SIDE][GRID_SIDE] = {
+            {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
+            {1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1},
+            {1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1},
+            {1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1},
+            {1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 0, 0,
+                    0, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 2, 0, 0, 0, 0, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1,
+                    0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1,
+                    0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 1,
+                    0, 0, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
+            {1, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1,
+                    0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 1},
+            {1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1,
+                    0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1},
+            {1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0,
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1},
+            {1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1},
+            {1, 0, 0, 1, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0,
+                    0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1},
+            {1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1},
+            {1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1},
+            {1, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1,
+                    0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 1,
+                    0, 0, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1,
+                    0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1,
+                    0, 0, 2, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1,
+                    0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
+            {1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1},
+            {1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1},
+            {1, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0,
+                    0, 0, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
+            {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
+            {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1}};
+    loadGameField(field, fieldMap);
+}
+
+// 連接迷宮房間
+void connectVertex(GameField &field, Location vertex1, Location vertex2) {
+    switch (vertex1.row - vertex2.row) {
+        // 打掉 vertex 1 上方
+        case 1:
+            setFieldCell(field, 1 + vertex1.row * 3 - 1, 1 + vertex1.col * 3, 0);
+            setFieldCell(field, 1 + vertex1.row * 3 - 1, 1 + vertex1.col * 3 + 1, 0);
+            break;
+            // 打掉 vertex 1 下方
+        case -1:
+            setFieldCell(field, 1 + vertex1.row * 3 + 2, 1 + vertex1.col * 3, 0);
+            setFieldCell(field, 1 + vertex1.row * 3 + 2, 1 + vertex1.col * 3 + 1, 0);
+            break;
+        default:
+            break;
+    }
+
+    switch (vertex1.col - vertex2.col) {
+        // 打掉 vertex 1 左方
+        case 1:
+            setFieldCell(field, 1 + vertex1.row * 3, 1 + vertex1.col * 3 - 1, 0);
+            setFieldCell(field, 1 + vertex1.row * 3 + 1, 1 + vertex1.col * 3 - 1, 0);
+            break;
+            // 打掉 vertex 1 右方
+        case -1:
+            setFieldCell(field, 1 + vertex1.row * 3, 1 + vertex1.col * 3 + 2, 0);
+            setFieldCell(field, 1 + vertex1.row * 3 + 1, 1 + vertex1.col * 3 + 2, 0);
+            break;
+        default:
+            break;
+    }
+}
+
+// DFS 演算迷宮生成
+void vertexDfsVisit(GameSession &session, GameField &field, Location startVertex) {
+    int searchDirection = randomBelow(session.random[RANDOM_MAZE], 4); // 對應 0: 上 1: 下 2: 左 3: 右
+    session.found[startVertex.row][startVertex.col] = true;
+
+    for (int i = 0; i < 4; i++) {
+        switch ((searchDirection + i) % 4) {
+            case 0:
+                if (startVertex.row != 0) {
+                    if (!session.found[startVertex.row - 1][startVertex.col]) {
+                        connectVertex(field, startVertex, {startVertex.row - 1, startVertex.col});
+
+                        vertexDfsVisit(session, field, {startVertex.row - 1, startVertex.col});
+                    } else if (randomBelow(session.random[RANDOM_MAZE], 5) == 0) {
+                        connectVertex(field, startVertex, {startVertex.row - 1, startVertex.col});
+                    }
+                }
+                break;
+            case 1:
+                if (startVertex.row != 12) {
+                    if (!session.found[startVertex.row + 1][startVertex.col]) {
+                        connectVertex(field, startVertex, {startVertex.row + 1, startVertex.col});
+
+                        vertexDfsVisit(session, field, {startVertex.row + 1, startVertex.col});
+                    } else if (randomBelow(session.random[RANDOM_MAZE], 5) == 0) {
+                        connectVertex(field, startVertex, {startVertex.row + 1, startVertex.col});
+                    }
+                }
+                break;
+            case 2:
+                if (startVertex.col != 0) {
+                    if (!session.found[startVertex.row][startVertex.col - 1]) {
+                        connectVertex(field, startVertex, {startVertex.row, startVertex.col - 1});
+
+                        vertexDfsVisit(session, field, {startVertex.row, startVertex.col - 1});
+                    } else if (randomBelow(session.random[RANDOM_MAZE], 5) == 0) {
+                        connectVertex(field, startVertex, {startVertex.row, startVertex.col - 1});
+                    }
+                }
+                break;
+            case 3:
+                if (startVertex.col != 12) {
+                    if (!session.found[startVertex.row][startVertex.col + 1]) {
+                        connectVertex(field, startVertex, {startVertex.row, startVertex.col + 1});
+
+                        vertexDfsVisit(session, field, {startVertex.row, startVertex.col + 1});
+                    } else if (randomBelow(session.random[RANDOM_MAZE], 5) == 0) {
+                        connectVertex(field, startVertex, {startVertex.row, startVertex.col + 1});
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// 生成迷宮
+void generateMaze(GameSession &session, GameField &field) {
+    // 初始化迷宮地圖為全牆壁：列號是 3 的倍數的整列是牆，其他列只有行號是 3 的倍數的格子是牆
+    GameBitboards lattice = {};
+    uint64_t latticeColumns = 0;
+    for (int j = 0; j < GRID_SIDE; j += 3) {
+        latticeColumns |= uint64_t(1) << j;
+    }
+    for (int i = 0; i < GRID_SIDE; ++i) {
+        lattice.wall.rows[i] = i % 3 == 0 ? BITBOARD_ROW_MASK : latticeColumns;
+    }
+    bitboardsToField(lattice, field);
+
+    for (auto &i: session.found) {
+        for (int &j: i) {
+            j = 0;
+        }
+    }
+
+    int startRow = randomBelow(session.random[RANDOM_MAZE], 13);
+    int startCol = randomBelow(session.random[RANDOM_MAZE], 13);
+    vertexDfsVisit(session, field, {startRow, startCol});
+
+    for (int i = 3; i < 19; i += 3) {
+        setFieldCell(field, 1, i, 0);
+        setFieldCell(field, 2, i, 0);
+    }
+
+    // 删除上下左右都为空的牆壁：先取得空格遮罩，同一列的上、下、左、右四個位移做 AND 就是要刪除的牆
+    // 被刪除的牆四周原本就是空格，所以一次算完與逐格刪除的結果相同
+    uint64_t empty[FIELD_MASK_WORDS];
+    const uint64_t inner = ((uint64_t(1) << (GRID_SIDE - 6)) - 1) << 3;
+    cellScan.mask(field.cells, FIELD_SIZE, EMPTY, empty);
+    for (int i = 3; i < GRID_SIDE - 3; i += 1) {
+        uint64_t open = cellMaskBits(empty, fieldIndex(i - 1, 0), GRID_SIDE) &
+                        cellMaskBits(empty, fieldIndex(i + 1, 0), GRID_SIDE) &
+                        cellMaskBits(empty, fieldIndex(i, -1), GRID_SIDE) &
+                        cellMaskBits(empty, fieldIndex(i, 1), GRID_SIDE) & inner;
+        while (open != 0) {
+            setFieldCell(field, i, __builtin_ctzll(open), 0);
+            open &= open - 1;
+        }
+    }
+}
+
+// 輸出遊戲紀錄，無介面模式同時執行大量遊戲，不輸出以免互相干擾
+void logSession(GameSession &session, const char *format, ...) {
+    if (session.headless)
+        return;
+
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+// 建立一局遊戲：複製遊戲場並以種子設定各子系統的亂數串流
+void initSession(GameSession &session, const GameField &field, uint64_t seed, bool headless) {
+    session.field = field;
+    session.headless = headless;
+    seedSessionRandom(session, seed);
+    initHorde(session.horde);
+    session.horde.freeCells = &session.freeCellIndex;
+    resetSessionProgress(session);
+}
+
+// 以種子重設這局遊戲所有子系統的亂數串流，每個子系統使用自己的串流編號
+void seedSessionRandom(GameSession &session, uint64_t seed) {
+    session.seed = seed;
+    for (int i = 0; i < RANDOM_STREAM_COUNT; i++) {
+        seedRandomStream(session.random[i], seed, uint32_t(i));
+    }
+}
+
+// Philox4x32-10 區塊函數，每一輪以兩個 32x32 位元乘法混合計數器，再更新金鑰
+void philoxBlock(const uint32_t key[2], const uint32_t counter[4], uint32_t out[4]) {
+    uint32_t k0 = key[0], k1 = key[1];
+    uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+
+    for (int round = 0; round < 10; round++) {
+        uint64_t product0 = uint64_t(0xD2511F53) * c0;
+        uint64_t product1 = uint64_t(0xCD9E8D57) * c2;
+        uint32_t next0 = uint32_t(product1 >> 32) ^ c1 ^ k0;
+        uint32_t next2 = uint32_t(product0 >> 32) ^ c3 ^ k1;
+        c1 = uint32_t(product1);
+        c3 = uint32_t(product0);
+        c0 = next0;
+        c2 = next2;
+        k0 += 0x9E3779B9;
+        k1 += 0xBB67AE85;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+// 以種子與串流編號設定亂數串流，種子作為金鑰，串流編號放在計數器的高位
+void seedRandomStream(RandomStream &random, uint64_t seed, uint32_t stream) {
+    random.key[0] = uint32_t(seed);
+    random.key[1] = uint32_t(seed >> 32);
+    random.stream = stream;
+    random.counter = 0;
+    random.used = 4;  // 第一次取用時才產生區塊
+}
+
+// 取出串流的下一個 32 位元亂數，每四個亂數產生一個新的區塊
+uint32_t nextRandom(RandomStream &random) {
+    if (random.used == 4) {
+        const uint32_t counter[4] = {uint32_t(random.counter), uint32_t(random.counter >> 32), random.stream, 0};
+        philoxBlock(random.key, counter, random.block);
+        random.counter++;
+        random.used = 0;
+    }
+    return random.block[random.used++];
+}
+
+// 取出 0 到 bound - 1 之間的亂數，以乘法取代取餘數
+int randomBelow(RandomStream &random, int bound) {
+    return int((uint64_t(nextRandom(random)) * uint32_t(bound)) >> 32);
+}
+
+// 由種子切分出第 index 個子種子，使用一般串流不會用到的最後一個計數器字，不會與任何串流重疊
+uint64_t splitSeed(uint64_t seed, uint64_t index) {
+    const uint32_t key[2] = {uint32_t(seed), uint32_t(seed >> 32)};
+    const uint32_t counter[4] = {uint32_t(index), uint32_t(index >> 32), 0, 1};
+    uint32_t out[4];
+    philoxBlock(key, counter, out);
+    return uint64_t(out[0]) | uint64_t(out[1]) << 32;
+}
+
+// 回到第一關並清除分數與時間
+void resetSessionProgress(GameSession &session) {
+    session.level = 1;
+    session.scoreSum = 0;
+    session.level_sum_score = PASS_SCORE;
+    session.totalTime = 0;
+    session.speed = INIT_SPEED;
+}
+
+// 開始一個關卡：重設生存者、喪屍群與索引，產生第一份資源
+void startGame(GameSession &session) {
+    GameField &field = session.field;
+    ZombieHorde &horde = session.horde;
+    resetHorde(horde);
+    buildFreeCellIndex(session.freeCellIndex, field, horde);  // 迷宮可能已重新生成
+    buildResourceIndex(session.resourceIndex, field);
+    spawnZombie(horde, 16, 16, RIGHT);  // 設定第一隻喪屍初始位置和方向
+
+    // 第一位生存者在固定的起點，其餘隨機放在不是牆也沒有喪屍的格子
+    std::vector<int> picked;
+    session.survivors.assign(1, Entity{1, 2, RIGHT, nullptr, false});  // 設定勇者初始位置和方向
+    pickFreeCells(session.random[RANDOM_SQUAD], session.freeCellIndex, session.squadSize - 1, picked);
+    for (int cell: picked) {
+        session.survivors.push_back(Entity{cell / GRID_SIDE, cell % GRID_SIDE, RIGHT, nullptr, false});
+    }
+
+    session.speed = INIT_SPEED;
+    session.stepCount = 0;
+    session.killedCount = 0;
+    session.tickPlanned = false;
+    session.rateStart = std::chrono::steady_clock::now();  // 關卡之間等待按鍵的時間不算在回合速度中
+    session.rateTicks = 0;
+    resetZombieInfluence(session);
+    resetDiffusionField(session);
+    drawGameField(session);                  // 繪製遊戲區域
+    createResource(session, field, horde);  // 產生第一份資源
+}
+
+// 進行一個回合，沒有自訂規則時使用常數折疊的 ClassicRules
+StepResult stepGame(GameSession &session) {
+    if (session.customRules)
+        return stepGameWithRules(session, session.rules);
+    return stepGameWithRules(session, ClassicRules());
+}
+
+// 累計一個回合，量測區間結束時以區間內的回合數更新每秒回合數
+void updateTickRate(GameSession &session) {
+    session.rateTicks++;
+    double elapsed = std::chrono::duration<double>(session.tickStart - session.rateStart).count();
+    if (elapsed * 1000 >= TICK_RATE_WINDOW_MS) {
+        session.ticksPerSecond = session.rateTicks / elapsed;
+        session.rateTicks = 0;
+        session.rateStart = session.tickStart;
+    }
+}
+
+// 設定這局遊戲之後的回合使用的規則
+bool setSessionRules(GameSession &session, const RuntimeRules &rules) {
+    if (rules.side() != GRID_SIDE) {
+        logSession(session, "The rules side %d does not match the field side %d\n", rules.side(), GRID_SIDE);
+        return false;
+    }
+    if (rules.maxEvalPath() < 1 || rules.maxEvalPath() > MAX_EVAL_PATH || rules.perResourceKill() < 1 ||
+        rules.zombieMoveInterval() < 1 || rules.zombieSpawnInterval() < 1 || rules.resourceChance() < 1) {
+        logSession(session, "The rules are out of range\n");
+        return false;
+    }
+    session.rules = rules;
+    session.customRules = true;
+    invalidateWallPenaltyTable(session);  // 牆壁懲罰依規則計算，以新規則重建
+    return true;
+}
+
+// 這局遊戲目前的規則，RuntimeRules 的預設值與 ClassicRules 相同
+RuntimeRules sessionRules(const GameSession &session) {
+    if (session.customRules)
+        return session.rules;
+    return RuntimeRules();
+}
+
+// 依指定規則進行一個回合
+template<typename Rules>
+StepResult stepGameWithRules(GameSession &session, const Rules &rules) {
+    GameField &field = session.field;
+    ZombieHorde &horde = session.horde;
+
+    session.tickStart = std::chrono::steady_clock::now();
+    updateTickRate(session);
+    // 喪屍資料在所有生存者決策前準備一次，每位生存者只做自己的選擇
+    prepareTickPlanning(session);
+    for (Entity &survivor: session.survivors) {
+        controlPlayerDirection(
+                session, field, &survivor,
+                horde);  // 讀取生存者輸入方向鍵，或由AI決定方向
+    }
+    session.tickPlanned = false;
+    session.survivorPlanNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - session.tickStart).count();
+
+    for (Entity &survivor: session.survivors) {
+        movePlayer(session, &survivor);  // 依據節點的方向，繪製新的生存者位置
+
+        // 喪屍移動前先檢查，生存者與喪屍交換位置時兩者會互相穿過，移動後就檢查不到
+        if (IsAtZombie(horde, survivor.row, survivor.col))
+            survivor.caught = true;
+    }
+
+    if (session.stepCount % rules.zombieMoveInterval() == 0) {
+        controlZombieDirection(session, field, horde, rules.zombieMoveInterval());
+        moveZombie(session, field, horde);  // 依據節點的方向，繪製新的喪屍位置
+    }
+
+    // 新增喪屍數量
+    if (session.stepCount % rules.zombieSpawnInterval() == 0)
+        addZombie(session, horde);
+
+    for (Entity &survivor: session.survivors) {
+        playerCollectResource(
+                session, field, &survivor,
+                horde, rules.perResourceKill());  // 判斷生存者是否有收集到資源，如果有增加分數
+    }
+
+    session.totalTime += session.speed;
+    showInfo(session);  // 顯示時間和分數資訊
+    if (session.levelMode) {
+        if (session.totalTime / 1000 > MAX_PASS_TIME && session.scoreSum < session.level_sum_score) {
+            return STEP_TIME_UP;
+        } else if (session.scoreSum >= session.level_sum_score) {
+            session.level++;
+            session.level_sum_score += PASS_SCORE * session.level;
+            return STEP_LEVEL_PASSED;
+        }
+    }
+
+    if (!removeDeadSurvivors(session))  // 判斷是否符合遊戲結束條件，所有生存者都死亡才結束
+        return STEP_CAUGHT;
+
+    // 除了收集到資源會產生新資源，系統也隨機產生新資源
+    if (randomBelow(session.random[RANDOM_RESOURCE_ROLL], rules.resourceChance()) == 0)
+        createResource(session, field, horde);
+    session.stepCount++;
+    return STEP_RUNNING;
+}
+
+// 準備這回合所有生存者共用的規劃資料
+void prepareTickPlanning(GameSession &session) {
+    GameField &field = session.field;
+    const ZombieHorde &horde = session.horde;
+
+    refreshMazeTables(session, field);
+    updateZombieInfluence(session, horde);
+    fieldToBitboards(field, horde, nullptr, session.tickBits);
+    if (session.IFPlayAI && session.playerAIMode == AI_DIFFUSION)
+        updateDiffusionField(session, field, horde);
+    session.tickPlanned = true;
+}
+
+// 以所有生存者為來源做一次 BFS，每格記錄最近的生存者與步數
+void updateSurvivorField(GameSession &session) {
+    std::vector<int> sources;
+    for (const Entity &survivor: session.survivors) {
+        sources.push_back(fieldIndex(survivor.row, survivor.col));
+    }
+    rulesBreadthFirst(ClassicRules(), session.field.cells, sources.data(), int(sources.size()),
+                      session.survivorDistance, session.survivorOwner, session.survivorQueue);
+}
+
+// 移除撞牆或被抓到的生存者，回傳是否還有生存者
+bool removeDeadSurvivors(GameSession &session) {
+    std::vector<Entity> &survivors = session.survivors;
+    for (size_t i = survivors.size(); i-- > 0;) {
+        if (IsGameOver(session.horde, &survivors[i], session.field)) {
+            logSession(session, "The survivor at row: %d, col: %d is dead\n", survivors[i].row, survivors[i].col);
+            survivors.erase(survivors.begin() + i);
+        }
+    }
+    return !survivors.empty();
+}
+
+#ifdef SURVIVAL_THREADS
+// 啟動執行緒池
+void startThreadPool(ThreadPool &pool, int threadCount) {
+    pool.stopping = false;
+    for (int i = 0; i < threadCount; i++) {
+        pool.workers.emplace_back([&pool]() { threadPoolWorker(pool); });
+    }
+}
+
+// 等待所有工作完成後結束執行緒池
+void stopThreadPool(ThreadPool &pool) {
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.stopping = true;
+    }
+    pool.wake.notify_all();
+    for (auto &worker: pool.workers) {
+        worker.join();
+    }
+    pool.workers.clear();
+}
+
+// 加入一個工作到執行緒池
+void submitTask(ThreadPool &pool, std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.tasks.push_back(std::move(task));
+    }
+    pool.wake.notify_one();
+}
+
+// 等待執行緒池中所有工作完成
+void waitThreadPool(ThreadPool &pool) {
+    std::unique_lock<std::mutex> lock(pool.mutex);
+    pool.idle.wait(lock, [&pool]() { return pool.tasks.empty() && pool.running == 0; });
+}
+
+// 工作執行緒的主迴圈
+void threadPoolWorker(ThreadPool &pool) {
+    std::unique_lock<std::mutex> lock(pool.mutex);
+    while (true) {
+        pool.wake.wait(lock, [&pool]() { return pool.stopping || !pool.tasks.empty(); });
+        if (pool.tasks.empty())
+            return;  // 只有在沒有剩餘工作時才結束
+
+        std::function<void()> task = std::move(pool.tasks.front());
+        pool.tasks.pop_front();
+        pool.running++;
+        lock.unlock();
+        task();
+        lock.lock();
+        pool.running--;
+        if (pool.tasks.empty() && pool.running == 0)
+            pool.idle.notify_all();
+    }
+}
+
+// 以執行緒池讓每局無介面遊戲各進行一個回合，結束的遊戲直接開始下一局，results 紀錄每局這回合的結果
+void stepSessions(ThreadPool &pool, std::vector<std::unique_ptr<GameSession>> &sessions,
+                  std::vector<StepResult> &results) {
+    // 每個工作處理連續的一段遊戲，工作數為執行緒數的數倍讓快慢不一的遊戲能平均分配
+    int count = int(sessions.size());
+    int chunk = std::max(1, count / std::max(1, int(pool.workers.size()) * 4));
+    results.assign(count, STEP_RUNNING);
+
+    for (int first = 0; first < count; first += chunk) {
+        int last = std::min(count, first + chunk);
+        submitTask(pool, [&sessions, &results, first, last]() {
+            for (int i = first; i < last; i++) {
+                GameSession &session = *sessions[i];
+                results[i] = stepGame(session);
+                if (results[i] == STEP_RUNNING)
+                    continue;
+                if (results[i] != STEP_LEVEL_PASSED || session.level > MAX_LEVEL)
+                    resetSessionProgress(session);  // 死亡、時間到或破完所有關卡就從第一關重新開始
+                startGame(session);
+            }
+        });
+    }
+    waitThreadPool(pool);
+}
+#endif
+
+// 繪製遊戲區域，沒有前端時不做任何事
+void drawGameField(GameSession &session) {
+    if (session.observer != nullptr)
+        session.observer->drawField(session);
+}
+
+// 繪製方塊，沒有前端時不做任何事
+void drawSquare(GameSession &session, int row, int col, CellPaint paint) {
+    if (session.observer != nullptr)
+        session.observer->drawCell(session, row, col, paint);
+}
+
+// 繪製喪屍每前進一步的改變
+// 先擦掉所有舊位置、更新位置後再畫上新位置，避免擦掉剛走到同一格的其他喪屍
+void moveZombie(GameSession &session, GameField &field, ZombieHorde &horde) {
+    int count = hordeSize(horde);
+
+    for (int i = 0; i < count; i++) {
+        int currRow = horde.row[i];
+        int currCol = horde.col[i];
+
+        if (field[currRow][currCol] == RESOURCE)
+            drawSquare(session, currRow, currCol, PAINT_RESOURCE);
+        else
+            drawSquare(session, currRow, currCol, PAINT_EMPTY);
+    }
+
+    advanceZombies(horde);
+
+    for (int i = 0; i < count; i++) {
+        drawSquare(session, horde.row[i], horde.col[i], PAINT_ZOMBIE);
+    }
+}
+
+// 依據各喪屍的方向屬性，設定移動下一步的位置，並更新每格的喪屍數量
+// 位移以比較結果計算，迴圈沒有分支，編譯器可以直接向量化；佔用表的分散寫入另外處理
+void advanceZombies(ZombieHorde &horde) {
+    int count = hordeSize(horde);
+    int *rows = horde.row.data();
+    int *cols = horde.col.data();
+    const Direction *directs = horde.direct.data();
+
+    for (int i = 0; i < count; i++) {
+        vacateCell(horde, rows[i], cols[i]);
+    }
+
+    for (int i = 0; i < count; i++) {
+        int direct = directs[i];
+        rows[i] += (direct == DOWN) - (direct == UP);
+        cols[i] += (direct == RIGHT) - (direct == LEFT);
+    }
+
+    for (int i = 0; i < count; i++) {
+        occupyCell(horde, rows[i], cols[i]);
+    }
+}
+
+// 喪屍群的數量
+int hordeSize(const ZombieHorde &horde) {
+    return int(horde.row.size());
+}
+
+// 在喪屍群尾端加入一隻喪屍，新喪屍儘快完整規劃一次
+// 優先重複使用已釋放的槽位，容量足夠時不會配置記憶體
+ZombieHandle spawnZombie(ZombieHorde &horde, int row, int col, Direction direct) {
+    int slot;
+    if (!horde.freeSlots.empty()) {
+        slot = horde.freeSlots.back();
+        horde.freeSlots.pop_back();
+    } else {
+        slot = int(horde.slotIndex.size());
+        horde.slotIndex.push_back(-1);
+        horde.generation.push_back(0);
+    }
+
+    horde.slotIndex[slot] = hordeSize(horde);
+    horde.row.push_back(row);
+    horde.col.push_back(col);
+    horde.direct.push_back(direct);
+    horde.planTick.push_back(-zombieLodInterval);  // 與排程器使用相同的間隔，新的喪屍一定視為過期
+    horde.slot.push_back(slot);
+    occupyCell(horde, row, col);
+
+    return {slot, horde.generation[slot]};
+}
+
+// 移除第 index 隻喪屍，以最後一隻喪屍填補空位，不需要搬移其他喪屍
+void removeZombie(ZombieHorde &horde, int index) {
+    int last = hordeSize(horde) - 1;
+    int freed = horde.slot[index];
+
+    vacateCell(horde, horde.row[index], horde.col[index]);
+    horde.slotIndex[horde.slot[last]] = index;
+    horde.slotIndex[freed] = -1;
+    horde.generation[freed]++;
+    horde.freeSlots.push_back(freed);
+
+    horde.row[index] = horde.row[last];
+    horde.col[index] = horde.col[last];
+    horde.direct[index] = horde.direct[last];
+    horde.planTick[index] = horde.planTick[last];
+    horde.slot[index] = horde.slot[last];
+    horde.row.pop_back();
+    horde.col.pop_back();
+    horde.direct.pop_back();
+    horde.planTick.pop_back();
+    horde.slot.pop_back();
+}
+
+// 以 handle 移除喪屍，handle 已失效時不做任何事
+void despawnZombie(ZombieHorde &horde, ZombieHandle handle) {
+    int index = zombieIndex(horde, handle);
+    if (index != -1)
+        removeZombie(horde, index);
+}
+
+// 查詢 handle 目前對應的喪屍索引，已失效回傳 -1
+int zombieIndex(const ZombieHorde &horde, ZombieHandle handle) {
+    if (handle.slot < 0 || handle.slot >= int(horde.slotIndex.size()) ||
+        horde.generation[handle.slot] != handle.generation)
+        return -1;
+    return horde.slotIndex[handle.slot];
+}
+
+// 預先保留喪屍群的容量
+void initHorde(ZombieHorde &horde) {
+    horde.row.reserve(ZOMBIE_POOL_CAPACITY);
+    horde.col.reserve(ZOMBIE_POOL_CAPACITY);
+    horde.direct.reserve(ZOMBIE_POOL_CAPACITY);
+    horde.planTick.reserve(ZOMBIE_POOL_CAPACITY);
+    horde.slot.reserve(ZOMBIE_POOL_CAPACITY);
+    horde.slotIndex.reserve(ZOMBIE_POOL_CAPACITY);
+    horde.generation.reserve(ZOMBIE_POOL_CAPACITY);
+    horde.freeSlots.reserve(ZOMBIE_POOL_CAPACITY);
+}
+
+// 清空喪屍群但保留已配置的容量，所有槽位放回可用清單，舊的 handle 全部失效
+void resetHorde(ZombieHorde &horde) {
+    for (int index = 0; index < hordeSize(horde); index++) {
+        int slot = horde.slot[index];
+        vacateCell(horde, horde.row[index], horde.col[index]);
+        horde.slotIndex[slot] = -1;
+        horde.generation[slot]++;
+        horde.freeSlots.push_back(slot);
+    }
+
+    horde.row.clear();
+    horde.col.clear();
+    horde.direct.clear();
+    horde.planTick.clear();
+    horde.slot.clear();
+}
+
+// 某格增加一隻喪屍，原本沒有喪屍時設定喪屍位元並從可放置格子索引移除
+void occupyCell(ZombieHorde &horde, int row, int col) {
+    if (horde.occupancy[row][col]++ != 0)
+        return;
+    setBit(horde.zombieBits, row, col);
+    if (horde.freeCells != nullptr)
+        removeFreeCell(*horde.freeCells, row * GRID_SIDE + col);
+}
+
+// 某格減少一隻喪屍，變成沒有喪屍時清除喪屍位元並加回可放置格子索引
+void vacateCell(ZombieHorde &horde, int row, int col) {
+    if (--horde.occupancy[row][col] != 0)
+        return;
+    clearBit(horde.zombieBits, row, col);
+    if (horde.freeCells != nullptr)
+        addFreeCell(*horde.freeCells, row * GRID_SIDE + col);
+}
+
+// 設定位元棋盤中的一格
+void setBit(BitBoard &board, int row, int col) {
+    if (row < 0 || row >= GRID_SIDE || col < 0 || col >= GRID_SIDE)
+        return;
+    board.rows[row] |= uint64_t(1) << col;
+}
+
+// 清除位元棋盤中的一格
+void clearBit(BitBoard &board, int row, int col) {
+    if (row < 0 || row >= GRID_SIDE || col < 0 || col >= GRID_SIDE)
+        return;
+    board.rows[row] &= ~(uint64_t(1) << col);
+}
+
+// 查詢位元棋盤中的一格
+bool testBit(const BitBoard &board, int row, int col) {
+    if (row < 0 || row >= GRID_SIDE || col < 0 || col >= GRID_SIDE)
+        return false;
+    return (board.rows[row] >> col) & 1;
+}
+
+// 兩個位元棋盤的交集
+BitBoard bitboardAnd(const BitBoard &a, const BitBoard &b) {
+    BitBoard result;
+    for (int row = 0; row < GRID_SIDE; row++) {
+        result.rows[row] = a.rows[row] & b.rows[row];
+    }
+    return result;
+}
+
+// 兩個位元棋盤的聯集
+BitBoard bitboardOr(const BitBoard &a, const BitBoard &b) {
+    BitBoard result;
+    for (int row = 0; row < GRID_SIDE; row++) {
+        result.rows[row] = a.rows[row] | b.rows[row];
+    }
+    return result;
+}
+
+// 在 a 中但不在 b 中的格子
+BitBoard bitboardAndNot(const BitBoard &a, const BitBoard &b) {
+    BitBoard result;
+    for (int row = 0; row < GRID_SIDE; row++) {
+        result.rows[row] = a.rows[row] & ~b.rows[row];
+    }
+    return result;
+}
+
+// 位元棋盤是否有任何格子
+bool bitboardAny(const BitBoard &board) {
+    uint64_t any = 0;
+    for (uint64_t bits: board.rows) {
+        any |= bits;
+    }
+    return any != 0;
+}
+
+// 位元棋盤的格子數量
+int bitboardCount(const BitBoard &board) {
+    int count = 0;
+    for (uint64_t bits: board.rows) {
+        count += __builtin_popcountll(bits);
+    }
+    return count;
+}
+
+// 位元棋盤往上下左右擴張一格：左右是同一列的位移，上下是相鄰列的聯集
+BitBoard dilateBitboard(const BitBoard &board) {
+    BitBoard result;
+    for (int row = 0; row < GRID_SIDE; row++) {
+        uint64_t bits = board.rows[row];
+        uint64_t dilated = bits | ((bits << 1) & BITBOARD_ROW_MASK) | (bits >> 1);
+        if (row > 0)
+            dilated |= board.rows[row - 1];
+        if (row < GRID_SIDE - 1)
+            dilated |= board.rows[row + 1];
+        result.rows[row] = dilated;
+    }
+    return result;
+}
+
+// 喪屍所在與相鄰的格子
+BitBoard zombieDanger(const ZombieHorde &horde) {
+    return dilateBitboard(horde.zombieBits);
+}
+
+// 由遊戲場、喪屍群與生存者建立位元平面，牆與資源平面的每一列直接從遮罩中取出
+void fieldToBitboards(GameField &field, const ZombieHorde &horde, EntityPointer player, GameBitboards &bits) {
+    uint64_t walls[FIELD_MASK_WORDS], resources[FIELD_MASK_WORDS];
+    cellScan.mask(field.cells, FIELD_SIZE, WALL, walls);
+    cellScan.mask(field.cells, FIELD_SIZE, RESOURCE, resources);
+    for (int row = 0; row < GRID_SIDE; row++) {
+        bits.wall.rows[row] = cellMaskBits(walls, fieldIndex(row, 0), GRID_SIDE);
+        bits.resource.rows[row] = cellMaskBits(resources, fieldIndex(row, 0), GRID_SIDE);
+        bits.player.rows[row] = 0;
+    }
+    bits.zombie = horde.zombieBits;
+    if (player != nullptr)
+        setBit(bits.player, player->row, player->col);
+}
+
+// 由位元平面寫回遊戲場，牆優先於資源，其餘格子為空白
+void bitboardsToField(const GameBitboards &bits, GameField &field) {
+    for (int row = 0; row < GRID_SIDE; row++) {
+        for (int col = 0; col < GRID_SIDE; col++) {
+            if ((bits.wall.rows[row] >> col) & 1)
+                setFieldCell(field, row, col, WALL);
+            else if ((bits.resource.rows[row] >> col) & 1)
+                setFieldCell(field, row, col, RESOURCE);
+            else
+                setFieldCell(field, row, col, EMPTY);
+        }
+    }
+}
+
+// 生存者四個方向中，不會撞牆也不會靠近喪屍的方向，以 (1 << Direction) 的位元回傳
+// 生存者平面擴張一格就是下一步的候選格子，與擴張後的喪屍平面取交集就是會靠近喪屍的格子，
+// 扣掉牆與這些格子後四個方向各只需要一次查詢；回合中直接使用共用的位元平面，不再轉換遊戲場
+int safePlayerMoves(GameSession &session, EntityPointer player, const ZombieHorde &horde) {
+    GameBitboards bits;
+    if (session.tickPlanned) {
+        bits = session.tickBits;
+        setBit(bits.player, player->row, player->col);
+    } else {
+        fieldToBitboards(session.field, horde, player, bits);
+    }
+
+    BitBoard neighbours = dilateBitboard(bits.player);
+    BitBoard threatened = bitboardAnd(dilateBitboard(bits.zombie), neighbours);
+    BitBoard open = bitboardAndNot(bitboardAndNot(neighbours, bits.wall), threatened);
+    if (!bitboardAny(open))
+        return 0;
+
+    const Direction directs[] = {RIGHT, LEFT, UP, DOWN};
+    int moves = 0;
+    for (Direction direct: directs) {
+        Location loc = nextStepLoc(player, direct);
+        if (testBit(open, loc.row, loc.col))
+            moves |= 1 << direct;
+    }
+    return moves;
+}
+
+// 依遊戲場與喪屍群重建可放置格子索引，牆壁只在迷宮重新生成時改變，所以每局開始前重建一次即可
+void buildFreeCellIndex(FreeCellIndex &index, GameField &field, const ZombieHorde &horde) {
+    index.cells.clear();
+    for (int row = 0; row < GRID_SIDE; row++) {
+        for (int col = 0; col < GRID_SIDE; col++) {
+            int cell = row * GRID_SIDE + col;
+            index.walkable[cell] = !IsAtWall(field, row, col);
+            index.position[cell] = -1;
+            if (!IsAtZombie(horde, row, col))
+                addFreeCell(index, cell);
+        }
+    }
+}
+
+// 將格子加入可放置格子索引，牆壁或已在索引中的格子不處理
+void addFreeCell(FreeCellIndex &index, int cell) {
+    if (!index.walkable[cell] || index.position[cell] != -1)
+        return;
+    index.position[cell] = int(index.cells.size());
+    index.cells.push_back(cell);
+}
+
+// 將格子移出可放置格子索引，以最後一個格子填補空位
+void removeFreeCell(FreeCellIndex &index, int cell) {
+    int position = index.position[cell];
+    if (position == -1)
+        return;
+    int last = index.cells.back();
+    index.cells[position] = last;
+    index.position[last] = position;
+    index.cells.pop_back();
+    index.position[cell] = -1;
+}
+
+// 隨機挑選一個可放置的格子，沒有可用格子時回傳 -1
+int randomFreeCell(RandomStream &random, const FreeCellIndex &index) {
+    if (index.cells.empty())
+        return -1;
+    return index.cells[randomBelow(random, int(index.cells.size()))];
+}
+
+// 以部分 Fisher-Yates 洗牌隨機挑選不重複的可放置格子，被選到的格子換到陣列前段
+void pickFreeCells(RandomStream &random, FreeCellIndex &index, int count, std::vector<int> &picked) {
+    int size = int(index.cells.size());
+    count = std::min(count, size);
+    picked.clear();
+
+    for (int i = 0; i < count; i++) {
+        int j = i + randomBelow(random, size - i);
+        std::swap(index.cells[i], index.cells[j]);
+        index.position[index.cells[i]] = i;
+        index.position[index.cells[j]] = j;
+        picked.push_back(index.cells[i]);
+    }
+}
+
+// 一次新增一波喪屍，生存者的格子在挑選時暫時移出索引
+void spawnZombieWave(GameSession &session, ZombieHorde &horde, const Entity *survivors, int survivorCount, int count,
+                     Direction direct) {
+    FreeCellIndex &index = *horde.freeCells;
+    std::vector<int> removed;
+    std::vector<int> picked;
+
+    for (int i = 0; i < survivorCount; i++) {
+        int cell = survivors[i].row * GRID_SIDE + survivors[i].col;
+        if (index.position[cell] != -1) {
+            removeFreeCell(index, cell);
+            removed.push_back(cell);
+        }
+    }
+    pickFreeCells(session.random[RANDOM_ZOMBIE], index, count, picked);
+    for (int cell: removed) {
+        addFreeCell(index, cell);
+    }
+
+    for (int cell: picked) {
+        spawnZombie(horde, cell / GRID_SIDE, cell % GRID_SIDE, direct);
+    }
+}
+
+// 繪製生存者每前進一步的改變
+void movePlayer(GameSession &session, EntityPointer player) {
+    int currRow, currCol;
+    if (player != nullptr) {
+        currRow = player->row;
+        currCol = player->col;
+
+        switch (player->direct) {
+            case RIGHT:
+                player->col++;
+                break;
+            case LEFT:
+                player->col--;
+                break;
+            case UP:
+                player->row--;
+                break;
+            case DOWN:
+                player->row++;
+                break;
+        }
+        drawSquare(session, player->row, player->col, PAINT_SURVIVOR);
+        drawSquare(session, currRow, currCol, PAINT_EMPTY);
+    }
+}
+
+// 判斷生存者是否死亡(死亡條件：撞牆和撞到自己身體)
+bool IsGameOver(const ZombieHorde &horde,
+                EntityPointer player,
+                GameField &field) {
+    // 判斷是否撞到牆
+    if (IsAtWall(field, horde.row[0], horde.col[0]))
+        return true;
+    if (IsAtWall(field, player->row, player->col))
+        return true;
+
+    // 檢查是否AI撞到喪屍，包含喪屍移動前就被抓到的情況
+    if (player->caught || IsAtZombie(horde, player->row, player->col))
+        return true;
+
+    return false;
+}
+
+// 判斷是否撞到牆
+bool IsAtWall(GameField &field, int row, int col) {
+    if (field.cells[fieldIndex(row, col)] == WALL)
+        return true;
+    return false;
+}
+
+// 遊戲場中 (row, col) 的線性索引
+int fieldIndex(int row, int col) {
+    return (row + 1) * FIELD_STRIDE + col + 1;
+}
+
+// 遊戲場線性索引對應的座標，哨兵格子的 row 或 col 會是 -1 或 GRID_SIDE
+Location fieldLocation(int cell) {
+    return {cell / FIELD_STRIDE - 1, cell % FIELD_STRIDE - 1};
+}
+
+// 由整數地圖載入遊戲場，先全部填成牆，外圍一圈就是哨兵
+// 整個遊戲場被取代，不逐格記錄日誌，而是把能重播的最早版本移到載入後，讓所有衍生的表重建
+void loadGameField(GameField &field, const int map[][GRID_SIDE]) {
+    for (uint8_t &cell: field.cells) {
+        cell = WALL;
+    }
+    for (int row = 0; row < GRID_SIDE; row++) {
+        for (int col = 0; col < GRID_SIDE; col++) {
+            field.cells[fieldIndex(row, col)] = uint8_t(map[row][col]);
+        }
+    }
+    field.version++;
+    field.wallVersion = field.version;
+    field.journalBase = field.version;
+}
+
+// 修改遊戲場的格子，牆壁有增減時一併更新牆壁版本
+void setFieldCell(GameField &field, int row, int col, uint8_t value) {
+    uint8_t &cell = field.cells[fieldIndex(row, col)];
+    if (cell == value)
+        return;
+
+    field.journal[field.version % FIELD_JOURNAL_SIZE] = {uint8_t(row), uint8_t(col), cell, value};
+    field.version++;
+    if ((cell == WALL) != (value == WALL))
+        field.wallVersion = field.version;
+    cell = value;
+}
+
+// 日誌是否還保留從 version 到目前版本的所有修改
+bool fieldJournalCovers(const GameField &field, uint64_t version) {
+    return version >= field.journalBase && version <= field.version &&
+           field.version - version <= FIELD_JOURNAL_SIZE;
+}
+
+// 從版本 version 到 version + 1 的修改
+const FieldChange &fieldChange(const GameField &field, uint64_t version) {
+    return field.journal[version % FIELD_JOURNAL_SIZE];
+}
+
+// 判斷是否撞到喪屍
+bool IsAtZombie(const ZombieHorde &horde, int row, int col) {
+    return zombiesAt(horde, row, col) > 0;
+}
+
+// 某格的喪屍數量，超出遊戲場視為沒有喪屍
+int zombiesAt(const ZombieHorde &horde, int row, int col) {
+    if (row < 0 || row >= GRID_SIDE || col < 0 || col >= GRID_SIDE)
+        return 0;
+    return horde.occupancy[row][col];
+}
+
+
+// 顯示遊戲相關資訊，沒有前端時不做任何事
+void showInfo(GameSession &session) {
+    if (session.observer != nullptr)
+        session.observer->showInfo(session);
+}
+
+// 讀取鍵盤方向輸入，並設定到生存者節點
+void controlPlayerDirection(GameSession &session, GameField &field,
+                            EntityPointer player,
+                            const ZombieHorde &horde) {
+    Direction playerDirect = player->direct;
+
+    // 只有第一位生存者由前端讀取方向鍵，沒有輸入時維持原方向
+    if (session.observer != nullptr && player == &session.survivors[0])
+        session.observer->readDirection(session, playerDirect);
+
+    if (session.IFPlayAI) {
+        switch (session.playerAIMode) {
+            case AI_DIFFUSION:
+                playerDirect = diffusionAI(session, field, player, horde);
+                break;
+            case AI_EXPECTIMAX:
+                playerDirect = expectimaxAI(session, field, player, horde);
+                break;
+            case AI_MCTS:
+                playerDirect = mctsAI(session, field, player, horde);
+                break;
+            default:
+                playerDirect = playerAI(session, field, player, horde);
+                break;
+        }
+    }
+
+    player->direct = playerDirect;
+}
+
+// 讀取鍵盤方向輸入，並設定到所有喪屍節點
+// 依距離分級：附近的喪屍每回合都需要重新規劃，遠方的喪屍隔 zombieLodInterval 回合才需要。
+// 需要規劃的喪屍依 (距離 - 過期回合加權) 排入優先佇列，在這回合剩餘的時間預算內依序做 A*，
+// 沒排到的喪屍這回合先往目標走一步，過期回合增加後下回合會優先處理
+void controlZombieDirection(GameSession &session, GameField &field,
+                            ZombieHorde &horde, int moveInterval) {
+    auto later = [](const PlanRequest &a, const PlanRequest &b) { return a.priority > b.priority; };
+    std::vector<PlanRequest> requests;
+    std::vector<EntityPointer> chased(hordeSize(horde));
+    int zombieTick = session.stepCount / moveInterval;
+    int count = hordeSize(horde);
+    int previousBacklog = session.schedulerStats.backlog;
+    session.zombiePlanStart = std::chrono::steady_clock::now();  // 生存者AI已用掉的時間不算在喪屍的預算中
+
+    // 一次多來源 BFS 就能得到每個喪屍最近的生存者，生存者越多也只需要一次
+    updateSurvivorField(session);
+    for (int index = 0; index < count; index++) {
+        int cell = fieldIndex(horde.row[index], horde.col[index]);
+        int owner = session.survivorDistance[cell] >= 0 ? session.survivorOwner[cell] : 0;
+        chased[index] = &session.survivors[owner];
+    }
+
+    for (int index = 0; index < count; index++) {
+        EntityPointer player = chased[index];
+        Location target = {player->row + index * 2, player->col + index * 2};
+        int distance = calculateDistance(horde.row[index], horde.col[index], player->row, player->col);
+        int staleness = zombieTick - horde.planTick[index];
+
+        if (distance <= zombieLodRange || staleness >= zombieLodInterval)
+            requests.push_back({distance - staleness * STALENESS_WEIGHT, index});
+
+        // 先給每個喪屍便宜的方向，排程器有時間時再以 A* 結果覆蓋
+        horde.direct[index] = greedyZombieDirect(field, horde, index, target);
+    }
+    std::make_heap(requests.begin(), requests.end(), later);
+
+    session.schedulerStats.planned = 0;
+    // 至少處理一個請求，確保預算很小時仍會前進；重播模式不受時間預算限制，每回合都規劃完
+    while (!requests.empty() &&
+           (session.deterministic || session.schedulerStats.planned == 0 || remainingTickBudget(session) > 0)) {
+        std::pop_heap(requests.begin(), requests.end(), later);
+        PlanRequest request = requests.back();
+        requests.pop_back();
+
+        EntityPointer player = chased[request.index];
+        Location target = {player->row + request.index * 2, player->col + request.index * 2};
+        horde.direct[request.index] = zombieAI(session, field, horde, request.index, target);
+        horde.planTick[request.index] = zombieTick;
+        session.schedulerStats.planned++;
+    }
+
+    session.schedulerStats.backlog = int(requests.size());
+    if (remainingTickBudget(session) < 0)
+        session.schedulerStats.overruns++;
+
+    // 只在延後的規劃數量改變時輸出，避免每個喪屍回合都輸出
+    if (session.schedulerStats.backlog != previousBacklog)
+        logSession(session, "Scheduler: planned %d, backlog %d, overruns %lld\n",
+                   session.schedulerStats.planned, session.schedulerStats.backlog, session.schedulerStats.overruns);
+}
+
+// 這回合喪屍規劃還剩下多少時間預算 (微秒)，負值表示已經超出預算
+long long remainingTickBudget(GameSession &session) {
+    auto elapsed = std::chrono::steady_clock::now() - session.zombiePlanStart;
+    return aiTickBudget - std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+// 產生資源
+void createResource(GameSession &session, GameField &field, const ZombieHorde &horde) {
+    int row, col, i, amount = RESOURCE_AMOUNT;
+
+    for (i = 0; i < amount; i++) {
+        // 直接從不是牆也沒有喪屍的格子中隨機挑選
+        int cell = randomFreeCell(session.random[RANDOM_RESOURCE], *horde.freeCells);
+        if (cell == -1)
+            return;
+        row = cell / GRID_SIDE;
+        col = cell % GRID_SIDE;
+
+        setFieldCell(field, row, col, RESOURCE);
+        drawSquare(session, row, col, PAINT_RESOURCE);
+    }
+}
+
+// 系統處理生存者收集到資源邏輯
+void playerCollectResource(GameSession &session, GameField &field,
+                           EntityPointer player,
+                           ZombieHorde &horde,
+                           int perResourceKill) {
+    // 如果生存者與資源位置重疊，就是收集到資源
+    if (field[player->row][player->col] == RESOURCE) {
+        setFieldCell(field, player->row, player->col, EMPTY);  // 將該資源清空
+        logSession(session, "The player has eaten food at row: %d, col: %d\n", player->row,
+                   player->col);
+        session.scoreSum += scorePerResource;   // 紀錄分數
+        createResource(session, field, horde);  // 產生新的資源
+
+        // 收集一定數量的資源可以消滅一個喪屍
+        if (session.scoreSum % perResourceKill == 0)
+            killZombie(session, horde);
+    }
+}
+
+// 增加喪屍數量
+void addZombie(GameSession &session, ZombieHorde &horde) {
+    // 將最後一位喪屍的方向屬性給新喪屍
+    spawnZombieWave(session, horde, session.survivors.data(), int(session.survivors.size()), ZOMBIE_WAVE_SIZE,
+                    horde.direct.back());
+}
+
+// 殺掉一個喪屍
+void killZombie(GameSession &session, ZombieHorde &horde) {
+    // 不會殺光所有喪屍，至少會保留一個
+    if (hordeSize(horde) <= 1)
+        return;
+
+    // 殺掉最後加入的喪屍
+    int killed = hordeSize(horde) - 1;
+    drawSquare(session, horde.row[killed], horde.col[killed], PAINT_EMPTY);
+    logSession(session, "\n(%d, %d) is killed\n", horde.row[killed], horde.col[killed]);
+    removeZombie(horde, killed);
+    session.killedCount++;
+}
+
+// 喪屍的AI控制
+Direction zombieAI(GameSession &session, GameField &field,
+                   const ZombieHorde &horde,
+                   int index,
+                   Location target) {
+    Direction zombieDirect;
+    Location start = {horde.row[index], horde.col[index]};
+
+    PathPointer path = zombieFindPath(session, field, start, target);
+    if (path) {
+        zombieDirect = getDirectionByPath(start, horde.direct[index], path);
+    } else
+        zombieDirect = safeDirect4Zombie(field, horde, index);
+
+    return zombieDirect;
+}
+
+// 從路徑資料判斷下一步方向
+Direction getDirectionByPath(Location start, Direction direct, PathPointer path) {
+    PathPointer nextPath = path->next;
+    int horizontal = nextPath->loc.col - start.col;
+    int vertical = nextPath->loc.row - start.row;
+    if (horizontal == 1)
+        return RIGHT;
+    else if (horizontal == -1)
+        return LEFT;
+
+    if (vertical == 1)
+        return DOWN;
+    else if (vertical == -1)
+        return UP;
+    return direct;
+}
+
+// 喪屍如果無法找到有效路徑，暫時決定一個安全方向
+Direction safeDirect4Zombie(GameField &field, const ZombieHorde &horde, int index) {
+    Location current = {horde.row[index], horde.col[index]};
+    Location loc = nextStepLoc(current, UP);
+    if (!IsAtWall(field, loc.row, loc.col))
+        return UP;
+    loc = nextStepLoc(current, DOWN);
+    if (!IsAtWall(field, loc.row, loc.col))
+        return DOWN;
+    loc = nextStepLoc(current, RIGHT);
+    if (!IsAtWall(field, loc.row, loc.col))
+        return RIGHT;
+    loc = nextStepLoc(current, LEFT);
+    if (!IsAtWall(field, loc.row, loc.col))
+        return LEFT;
+    return horde.direct[index];
+}
+
+// 遠方喪屍的簡化AI：直接往目標走一步；走不近目標時沿用原方向，原方向會撞牆才改用安全方向
+Direction greedyZombieDirect(GameField &field, const ZombieHorde &horde, int index, Location target) {
+    Location current = {horde.row[index], horde.col[index]};
+    int row = current.row, col = current.col;
+    modelZombieStep(field, row, col, target);
+
+    if (row > current.row)
+        return DOWN;
+    if (row < current.row)
+        return UP;
+    if (col > current.col)
+        return RIGHT;
+    if (col < current.col)
+        return LEFT;
+
+    Location loc = nextStepLoc(current, horde.direct[index]);
+    if (!IsAtWall(field, loc.row, loc.col))
+        return horde.direct[index];
+    return safeDirect4Zombie(field, horde, index);
+}
+
+// 喪屍尋找兩點之間可到達的路徑，不需考慮會不會撞到其他喪屍或者生存者
+PathPointer zombieFindPath(GameSession &session, GameField &field,
+                           Location startLoc,
+                           Location goalLoc) {
+    resetPathQueue(session);
+    resetPathArena(session);
+    int steps = calcSteps(startLoc, goalLoc);
+    PathNode start = {0, steps, startLoc, nullptr, nullptr};
+    addPathQueue(session, start);
+    while (!isPathQueueEmpty(session)) {
+        sortPathQueue(session);
+        PathPointer current = popPathQueue(session);
+        if (current == nullptr)
+            return nullptr;
+        if (current->loc.row == goalLoc.row && current->loc.col == goalLoc.col)
+            return buildPath(current);
+        int dirSize = 4;
+        int iDir[] = {1, 0, -1, 0};
+        int jDir[] = {0, 1, 0, -1};
+        int i, j;
+        for (i = 0, j = 0; i < dirSize; i++, j++) {
+            Location neighborLoc = {current->loc.row + iDir[i],
+                                    current->loc.col + jDir[j]};
+            if (!visited(session, neighborLoc) &&
+                !IsAtWall(field, neighborLoc.row, neighborLoc.col)) {
+                steps = calcSteps(neighborLoc, goalLoc);
+                int cost = current->cost + 1;
+                PathNode neighbor = {cost, steps, neighborLoc, current, nullptr};
+                if (!IsInPathQueue(session, neighbor)) {
+                    addPathQueue(session, neighbor);
+                }
+            }
+        }
+    }
+    return nullptr;
+}
+
+// 將之後要拜訪的節點放入佇列裡
+void addPathQueue(GameSession &session, PathNode pathNode) {
+    if (session.rear == MAX_QUEUE_SIZE - 1) {
+        logSession(session, "The queue is full rear: %d, front: %d\n", session.rear, session.front);
+        resetPathQueue(session);
+        return;
+    }
+    session.rear += 1;
+    session.pathQueue[session.rear] = pathNode;
+}
+
+// 傳回佇列中的路徑座標節點，並將它從佇列中刪除
+// 節點從路徑節點池取得，不需要個別釋放
+PathPointer popPathQueue(GameSession &session) {
+    if (session.front == session.rear) {
+        logSession(session, "the queue is empty");
+        return nullptr;
+    }
+    if (session.pathArenaUsed == MAX_QUEUE_SIZE) {
+        logSession(session, "The path arena is full\n");
+        return nullptr;
+    }
+    session.front++;
+    PathPointer node = &session.pathArena[session.pathArenaUsed++];
+    node->cost = session.pathQueue[session.front].cost;
+    node->steps = session.pathQueue[session.front].steps;
+    node->loc = session.pathQueue[session.front].loc;
+    node->parent = session.pathQueue[session.front].parent;
+    node->next = session.pathQueue[session.front].next;
+    return node;
+}
+
+// 判斷佇列是否為空
+bool isPathQueueEmpty(GameSession &session) {
+    return session.front == session.rear;
+}
+
+// 重設佇列
+void resetPathQueue(GameSession &session) {
+    session.front = -1;
+    session.rear = -1;
+}
+
+// 回收所有路徑節點，上一次搜尋回傳的路徑從此失效
+void resetPathArena(GameSession &session) {
+    session.pathArenaUsed = 0;
+}
+
+// 對佇列中的元素進行排序
+void sortPathQueue(GameSession &session) {
+    if (session.front == session.rear)
+        return;
+    int i, j;
+    int nowTotal, nextTotal;
+    for (i = session.front + 1; i < session.rear; i++) {
+        for (j = i + 1; j <= session.rear; j++) {
+            nowTotal = session.pathQueue[i].cost + session.pathQueue[i].steps;
+            nextTotal = session.pathQueue[j].cost + session.pathQueue[j].steps;
+
+            if (nowTotal > nextTotal) {
+                PathNode temp = session.pathQueue[i];
+                session.pathQueue[i] = session.pathQueue[j];
+                session.pathQueue[j] = temp;
+            }
+        }
+    }
+}
+
+// 判斷該元素是否在佇列之中
+bool IsInPathQueue(GameSession &session, PathNode pathNode) {
+    int i;
+    if (session.front == session.rear)
+        return false;
+    for (i = session.front; i <= session.rear; i++) {
+        if (session.pathQueue[i].loc.row == pathNode.loc.row &&
+            session.pathQueue[i].loc.col == pathNode.loc.col)
+            return true;
+    }
+    return false;
+}
+
+// 回傳到目標位置的路徑串列
+PathPointer buildPath(PathPointer goal) {
+    //printf("buildPath ");
+    //printf("(%d, %d)\n", goal->loc.row, goal->loc.col);
+    if (goal->parent == nullptr)
+        return nullptr;
+    PathPointer head = goal;
+    head->next = nullptr;
+    PathPointer temp = head;
+
+    while (head->parent) {
+        //printf("node (%d, %d)->", head->loc.row, head->loc.col);
+        head = head->parent;
+        head->next = temp;
+        temp = head;
+    }
+    //printf("nullptr\n");
+    return head;
+}
+
+// 計算兩點之間需要移動的步數
+int calcSteps(Location start, Location goal) {
+    int steps = abs(start.row - goal.row) + abs(start.col - goal.col);
+    return steps;
+}
+
+// 判斷是否該節點已經拜訪過
+bool visited(GameSession &session, Location loc) {
+    int i;
+    for (i = 0; i <= session.front; i++) {
+        if (session.pathQueue[i].loc.row == loc.row && session.pathQueue[i].loc.col == loc.col)
+            return true;
+    }
+    return false;
+}
+
+// 找尋最近的第 k 個資源，每次都掃描整個遊戲場並排序 (未使用資源索引的版本)
+Location findNearestKthResource(GameField &field, EntityPointer me, int k) {
+    std::vector<Location> resources;
+
+    // 資源不足 k 個時不需要掃描與排序，哨兵都是牆所以可以直接掃描整個遊戲場
+    int count = cellScan.count(field.cells, FIELD_SIZE, RESOURCE);
+    if (count < k)
+        return {-1, -1};
+
+    resources.reserve(count);
+    for (int cell = 0; cell < FIELD_SIZE; cell++) {
+        cell += cellScan.find(field.cells + cell, FIELD_SIZE - cell, RESOURCE);
+        if (cell < FIELD_SIZE)
+            resources.push_back(fieldLocation(cell));
+    }
+
+    std::sort(resources.begin(), resources.end(), [me](const Location &a, const Location &b) {
+        int rowDisA = abs(a.row - me->row);
+        int colDisA = abs(a.col - me->col);
+        int rowDisB = abs(b.row - me->row);
+        int colDisB = abs(b.col - me->col);
+        return (rowDisA + colDisA) < (rowDisB + colDisB);
+    });
+
+    if (k <= int(resources.size())) {
+        return resources[k - 1];
+    }
+
+    // 如果 k 是不存在資源回傳不存在
+    return {-1, -1};
+}
+
+// 依遊戲場重建資源索引，換關或重新生成迷宮時使用
+void buildResourceIndex(ResourceIndex &index, GameField &field) {
+    for (auto &bucketRow: index.bucket) {
+        for (auto &bucket: bucketRow) {
+            bucket.clear();
+        }
+    }
+    for (int &position: index.position) {
+        position = -1;
+    }
+    index.count = 0;
+
+    for (int cell = 0; cell < FIELD_SIZE; cell++) {
+        cell += cellScan.find(field.cells + cell, FIELD_SIZE - cell, RESOURCE);
+        if (cell < FIELD_SIZE)
+            addResource(index, fieldLocation(cell).row, fieldLocation(cell).col);
+    }
+    index.version = field.version;
+}
+
+// 依遊戲場的修改日誌更新資源索引：版本相同時不需要做任何事，
+// 否則重播落後的修改，資源被清掉的格子移出索引，新放資源的格子加入索引
+void syncResourceIndex(ResourceIndex &index, GameField &field) {
+    if (index.version == field.version)
+        return;
+    if (!fieldJournalCovers(field, index.version)) {
+        buildResourceIndex(index, field);
+        return;
+    }
+
+    for (uint64_t version = index.version; version < field.version; version++) {
+        const FieldChange &change = fieldChange(field, version);
+        if (change.oldValue == RESOURCE)
+            removeResource(index, change.row, change.col);
+        if (change.newValue == RESOURCE)
+            addResource(index, change.row, change.col);
+    }
+    index.version = field.version;
+}
+
+// 將資源加入資源索引，同一格重複產生資源時只記錄一次
+void addResource(ResourceIndex &index, int row, int col) {
+    int cell = row * GRID_SIDE + col;
+    if (index.position[cell] != -1)
+        return;
+    std::vector<int> &bucket = index.bucket[row / RESOURCE_BUCKET_SIZE][col / RESOURCE_BUCKET_SIZE];
+    index.position[cell] = int(bucket.size());
+    bucket.push_back(cell);
+    index.count++;
+}
+
+// 將資源移出資源索引，以桶子中最後一個資源填補空位
+void removeResource(ResourceIndex &index, int row, int col) {
+    int cell = row * GRID_SIDE + col;
+    int position = index.position[cell];
+    if (position == -1)
+        return;
+    std::vector<int> &bucket = index.bucket[row / RESOURCE_BUCKET_SIZE][col / RESOURCE_BUCKET_SIZE];
+    int last = bucket.back();
+    bucket[position] = last;
+    index.position[last] = position;
+    bucket.pop_back();
+    index.position[cell] = -1;
+    index.count--;
+}
+
+// 一次找出離指定座標最近的 k 個資源
+// 以生存者所在的桶子為中心一圈一圈擴大搜尋範圍，已找到 k 個且第 k 近的距離不超過
+// 範圍外任何格子的最短距離時就停止，通常只需要看少數幾個桶子
+void findNearestResources(const ResourceIndex &index, Location from, int k, std::vector<Location> &nearest) {
+    std::vector<std::pair<int, int>> candidates;  // (距離, 格子編號)
+    int centerRow = from.row / RESOURCE_BUCKET_SIZE;
+    int centerCol = from.col / RESOURCE_BUCKET_SIZE;
+    k = std::min(k, index.count);
+
+    for (int ring = 0; ring < RESOURCE_BUCKETS && k > 0; ring++) {
+        for (int bucketRow = centerRow - ring; bucketRow <= centerRow + ring; bucketRow++) {
+            if (bucketRow < 0 || bucketRow >= RESOURCE_BUCKETS)
+                continue;
+            for (int bucketCol = centerCol - ring; bucketCol <= centerCol + ring; bucketCol++) {
+                if (bucketCol < 0 || bucketCol >= RESOURCE_BUCKETS)
+                    continue;
+                // 只處理這一圈最外層的桶子，內層已經處理過
+                if (std::abs(bucketRow - centerRow) != ring && std::abs(bucketCol - centerCol) != ring)
+                    continue;
+                for (int cell: index.bucket[bucketRow][bucketCol]) {
+                    int distance = calculateDistance(from.row, from.col, cell / GRID_SIDE, cell % GRID_SIDE);
+                    candidates.push_back({distance, cell});
+                }
+            }
+        }
+
+        if (int(candidates.size()) < k)
+            continue;
+
+        // 範圍外的格子至少要跨出目前已搜尋的方形範圍
+        int top = (centerRow - ring) * RESOURCE_BUCKET_SIZE;
+        int bottom = (centerRow + ring + 1) * RESOURCE_BUCKET_SIZE - 1;
+        int left = (centerCol - ring) * RESOURCE_BUCKET_SIZE;
+        int right = (centerCol + ring + 1) * RESOURCE_BUCKET_SIZE - 1;
+        int outside = std::min(std::min(from.row - top, bottom - from.row),
+                               std::min(from.col - left, right - from.col)) + 1;
+
+        std::nth_element(candidates.begin(), candidates.begin() + (k - 1), candidates.end());
+        if (candidates[k - 1].first <= outside)
+            break;
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    nearest.clear();
+    for (int i = 0; i < k && i < int(candidates.size()); i++) {
+        nearest.push_back({candidates[i].second / GRID_SIDE, candidates[i].second % GRID_SIDE});
+    }
+}
+
+// 生存者如果無法找到有效路徑，暫時決定一個安全方向
+// 在不會撞牆或靠近喪屍的方向中，選擇死路深度最淺的方向
+Direction safeDirect(GameSession &session, GameField &field,
+                     EntityPointer player,
+                     const ZombieHorde &horde) {
+    refreshMazeTables(session, field);
+
+    Direction candidates[] = {UP, DOWN, RIGHT, LEFT};
+    Direction bestDirect = player->direct;
+    int bestDepth = TOPOLOGY_DEPTH_MASK + 1;
+    int moves = safePlayerMoves(session, player, horde);
+
+    for (Direction direct: candidates) {
+        if (!(moves & (1 << direct)))
+            continue;
+
+        Location loc = nextStepLoc(player, direct);
+        int depth = deadEndDepth(session, loc.row, loc.col);
+        if (depth < bestDepth) {
+            bestDepth = depth;
+            bestDirect = direct;
+        }
+    }
+
+    return bestDirect;
+}
+
+// 計算下一步的座標
+Location nextStepLoc(EntityPointer node, Direction direct) {
+    return nextStepLoc(Location{node->row, node->col}, direct);
+}
+
+// 計算從某個座標往指定方向走一步的座標
+Location nextStepLoc(Location current, Direction direct) {
+    int currRow = current.row;
+    int currCol = current.col;
+    int nextRow, nextCol;
+    Location loc{};
+    switch (direct) {
+        case RIGHT:
+            nextRow = currRow;
+            nextCol = currCol + 1;
+            break;
+        case LEFT:
+            nextRow = currRow;
+            nextCol = currCol - 1;
+            break;
+        case UP:
+            nextRow = currRow - 1;
+            nextCol = currCol;
+            break;
+        case DOWN:
+            nextRow = currRow + 1;
+            nextCol = currCol;
+            break;
+    }
+    loc.row = nextRow;
+    loc.col = nextCol;
+    return loc;
+}
+
+// 生存者尋找兩點之間可到達的路徑，必須考慮會不會撞到牆或者喪屍
+PathPointer playerFindPath(GameSession &session, GameField &field,
+                           Location startLoc,
+                           Location goalLoc,
+                           const ZombieHorde &horde) {
+    refreshMazeTables(session, field);
+
+    resetPathQueue(session);
+    resetPathArena(session);
+    int steps = calcSteps(startLoc, goalLoc);
+    PathNode start = {0, steps, startLoc, nullptr, nullptr};
+    addPathQueue(session, start);
+    while (!isPathQueueEmpty(session)) {
+        sortPathQueue(session);
+        PathPointer current = popPathQueue(session);
+        if (current == nullptr)
+            return nullptr;
+        if (current->loc.row == goalLoc.row && current->loc.col == goalLoc.col)
+            return buildPath(current);
+        int dirSize = 4;
+        int iDir[] = {1, 0, -1, 0};
+        int jDir[] = {0, 1, 0, -1};
+        int i, j;
+        for (i = 0, j = 0; i < dirSize; i++, j++) {
+            Location neighborLoc = {current->loc.row + iDir[i],
+                                    current->loc.col + jDir[j]};
+            if (!visited(session, neighborLoc) &&
+                !IsAtWall(field, neighborLoc.row, neighborLoc.col) &&
+                !IsCloseZombie(horde, neighborLoc.row, neighborLoc.col)) {
+                steps = calcSteps(neighborLoc, goalLoc);
+
+                int cost = 1;
+
+                // 特定範圍內殭屍的懲罰已在每回合疊加到影響地圖
+                cost += session.zombieInfluence[neighborLoc.row][neighborLoc.col];
+
+                cost += current->cost;
+
+                // 周圍牆壁越多越可能是死路，懲罰值在迷宮建立時已預先計算
+                cost += session.wallPenalty[neighborLoc.row][neighborLoc.col];
+
+                // 避免走進死路，以及在喪屍附近經過無法繞路的關節點
+                cost += deadEndDepth(session, neighborLoc.row, neighborLoc.col) * DEAD_END_PENALTY;
+                if (session.zombieInfluence[neighborLoc.row][neighborLoc.col] > 0 &&
+                    IsArticulationPoint(session, neighborLoc.row, neighborLoc.col))
+                    cost += CHOKE_POINT_PENALTY;
+
+                PathNode neighbor = {cost, steps, neighborLoc, current, nullptr};
+
+                if (!IsInPathQueue(session, neighbor)) {
+                    addPathQueue(session, neighbor);
+                }
+            }
+        }
+    }
+    return nullptr;
+}
+
+// 判斷是否會撞到喪屍
+// 與喪屍同格或上下左右相鄰，只需讀取佔用表的五個格子
+bool IsCloseZombie(const ZombieHorde &horde, int row, int col) {
+    return zombiesAt(horde, row, col) + zombiesAt(horde, row + 1, col) + zombiesAt(horde, row - 1, col) +
+           zombiesAt(horde, row, col + 1) + zombiesAt(horde, row, col - 1) > 0;
+}
+
+// 實作生存者AI
+Direction playerAI(GameSession &session, GameField &field,
+                   EntityPointer player,
+                   const ZombieHorde &horde) {
+    Direction playerDirect;
+
+    Location start = {player->row, player->col};
+
+    // 每回合只更新一次喪屍影響地圖，之後的路徑搜尋直接讀取；多位生存者時已由 prepareTickPlanning 更新
+    if (!session.tickPlanned)
+        updateZombieInfluence(session, horde);
+
+    Location target = evalBestLocation(session, field, player, horde);
+
+    PathPointer path = playerFindPath(session, field, start, target, horde);
+
+    // 只標示第一位生存者的目標，其他生存者會覆蓋 prevTarget
+    if (session.showTarget && (session.survivors.empty() || player == &session.survivors[0])) {
+        switch (field[session.prevTarget.row][session.prevTarget.col]) {
+            case WALL:  // 牆在矩陣中的值是1
+                drawSquare(session, session.prevTarget.row, session.prevTarget.col, PAINT_WALL);
+                break;
+            case RESOURCE:  // 資源在矩陣中的值是2
+                drawSquare(session, session.prevTarget.row, session.prevTarget.col, PAINT_RESOURCE);
+                break;
+        }
+        drawSquare(session, target.row, target.col, PAINT_TARGET);
+        session.prevTarget = target;
+    }
+
+    if (path) {
+        playerDirect = getDirectionByPath(Location{player->row, player->col}, player->direct, path);
+    } else
+        playerDirect = safeDirect(session, field, player, horde);
+
+    return playerDirect;
+}
+
+// 評估前往最佳地點
+Location evalBestLocation(GameSession &session, GameField &field, EntityPointer player, const ZombieHorde &horde) {
+    std::vector<ResourceEvaluation> evaluations;
+    std::vector<Location> resources;
+
+    // 資源索引先跟上遊戲場的修改，再一次取得最近的 maxEvalPath 個資源
+    int maxEvalPath = session.customRules ? session.rules.maxEvalPath() : ClassicRules::maxEvalPath();
+    syncResourceIndex(session.resourceIndex, field);
+    findNearestResources(session.resourceIndex, Location{player->row, player->col}, maxEvalPath, resources);
+
+    for (Location resource: resources) {
+        ResourceEvaluation evaluation = evalResourceCost(session, field, player, horde, resource);
+        evaluations.push_back(evaluation);
+    }
+
+    // 根據總成本排序
+    std::sort(evaluations.begin(), evaluations.end(), [](const ResourceEvaluation &a, const ResourceEvaluation &b) {
+        return a.cost < b.cost;
+    });
+
+    if (evaluations.empty() || evaluations[0].cost == -1) {
+        // 沒有找到資源，回傳無效座標
+        return {-1, -1};
+    }
+
+    logSession(session, "PathFind: [%d, %d]  Cost: %d\n",
+               evaluations[0].resource.row,
+               evaluations[0].resource.col,
+               evaluations[0].cost);
+
+    // 回傳最低成本座標
+    return evaluations[0].resource;
+}
+
+// 計算到達指定資源花費
+ResourceEvaluation evalResourceCost(GameSession &session, GameField &field, EntityPointer player, const ZombieHorde &horde, Location resource) {
+    Location start = {player->row, player->col};
+    PathPointer path = playerFindPath(session, field, start, resource, horde);
+
+    if (!path) {
+        // 當找不到有效路徑回傳該資源為無效花費
+        return {resource, 999};
+    }
+
+    return {resource, pathCost(path)};
+}
+
+// 計算路徑花費
+int pathCost(PathPointer path) {
+    while (path->next != nullptr) {
+        path = path->next;
+    }
+
+    return path->cost;
+}
+
+// 計算距離
+int calculateDistance(int row, int col, int row1, int col1) {
+    return abs(row1 - row) + abs(col1 - col);
+}
+
+// 預先計算喪屍影響範圍的菱形核心，距離 d 的格子懲罰為 (DETECT_ZOMBIE_RANGE - d) * 5
+void initInfluenceKernel() {
+    for (int dr = -DETECT_ZOMBIE_RANGE; dr <= DETECT_ZOMBIE_RANGE; dr++) {
+        for (int dc = -DETECT_ZOMBIE_RANGE; dc <= DETECT_ZOMBIE_RANGE; dc++) {
+            int distance = calculateDistance(0, 0, dr, dc);
+            int penalty = 0;
+            if (distance <= DETECT_ZOMBIE_RANGE)
+                penalty = (DETECT_ZOMBIE_RANGE - distance) * 5;
+            influenceKernel[dr + DETECT_ZOMBIE_RANGE][dc + DETECT_ZOMBIE_RANGE] = penalty;
+        }
+    }
+}
+
+// 以喪屍位置為中心疊加或移除影響核心，超出遊戲場的部分直接裁切
+void stampZombieInfluence(GameSession &session, Location center, int sign) {
+    int rowBegin = std::max(center.row - DETECT_ZOMBIE_RANGE, 0);
+    int rowEnd = std::min(center.row + DETECT_ZOMBIE_RANGE, GRID_SIDE - 1);
+    int colBegin = std::max(center.col - DETECT_ZOMBIE_RANGE, 0);
+    int colEnd = std::min(center.col + DETECT_ZOMBIE_RANGE, GRID_SIDE - 1);
+
+    for (int row = rowBegin; row <= rowEnd; row++) {
+        const int *kernelRow = influenceKernel[row - center.row + DETECT_ZOMBIE_RANGE];
+        for (int col = colBegin; col <= colEnd; col++) {
+            session.zombieInfluence[row][col] += sign * kernelRow[col - center.col + DETECT_ZOMBIE_RANGE];
+        }
+    }
+}
+
+// 每回合更新喪屍影響地圖
+// influenceStamps 與喪屍群使用相同索引；移除喪屍時最後一隻會搬到空位，
+// 這時該索引的舊影響屬於被移除的喪屍，比對位置不同就會被替換，多出的尾端則在最後移除
+void updateZombieInfluence(GameSession &session, const ZombieHorde &horde) {
+    size_t index = 0;
+    size_t count = horde.row.size();
+
+    for (; index < count; index++) {
+        Location current = {horde.row[index], horde.col[index]};
+        if (index == session.influenceStamps.size()) {
+            // 新加入的喪屍
+            stampZombieInfluence(session, current, 1);
+            session.influenceStamps.push_back(current);
+        } else if (session.influenceStamps[index].row != current.row || session.influenceStamps[index].col != current.col) {
+            // 有移動的喪屍才需要重新疊加
+            stampZombieInfluence(session, session.influenceStamps[index], -1);
+            stampZombieInfluence(session, current, 1);
+            session.influenceStamps[index] = current;
+        }
+    }
+
+    // 已經被殺掉的喪屍移除影響
+    while (session.influenceStamps.size() > index) {
+        stampZombieInfluence(session, session.influenceStamps.back(), -1);
+        session.influenceStamps.pop_back();
+    }
+}
+
+// 清空喪屍影響地圖
+void resetZombieInfluence(GameSession &session) {
+    session.influenceStamps.clear();
+    for (auto &row: session.zombieInfluence) {
+        for (int &cell: row) {
+            cell = 0;
+        }
+    }
+}
+
+// 建立每格周圍 3x3 的牆數與懲罰表，牆壁只有在迷宮重新生成時才會改變
+void buildWallPenaltyTable(GameSession &session, GameField &field) {
+    if (session.customRules)
+        buildRulesWallTable(session.rules, field.cells, &session.wallCount[0][0], &session.wallPenalty[0][0]);
+    else
+        buildRulesWallTable(ClassicRules(), field.cells, &session.wallCount[0][0], &session.wallPenalty[0][0]);
+    session.wallTableDirty = false;
+}
+
+// 牆壁改變時標記牆壁懲罰表需要重建
+void invalidateWallPenaltyTable(GameSession &session) {
+    session.wallTableDirty = true;
+}
+
+// 直接掃描 3x3 範圍計算牆壁懲罰
+int scanWallPenalty(GameField &field, int row, int col) {
+    int count = 0;
+
+    for (int dx = -1; dx <= 1; dx++) {
+        for (int dy = -1; dy <= 1; dy++) {
+            if (IsAtWall(field, row + dx, col + dy)) {
+                count++;
+            }
+        }
+    }
+
+    return rulesWallPenalty(ClassicRules(), count);
+}
+
+// 依這局遊戲的規則計算周圍有 count 面牆的格子的牆壁懲罰
+int sessionWallPenalty(const GameSession &session, int count) {
+    if (session.customRules)
+        return rulesWallPenalty(session.rules, count);
+    return rulesWallPenalty(ClassicRules(), count);
+}
+
+// 分析任意大小迷宮的拓撲，walkable 與 topology 皆為 rows * cols 的列優先陣列
+// 死路深度：反覆剝除可走鄰格不超過一個的格子，被剝除的格子與剩餘主體的距離即為深度
+// 關節點：以明確堆疊實作 Tarjan 演算法，避免大型地圖遞迴過深
+void analyzeMazeTopology(const uint8_t *walkable, int rows, int cols, uint8_t *topology) {
+    const int cellCount = rows * cols;
+    const int NONE = -1;
+    std::vector<uint8_t> degree(cellCount, 0);
+    std::vector<uint8_t> peeled(cellCount, 0);
+    std::vector<int> queue;
+    queue.reserve(cellCount);
+
+    // 取得第 i 個方向的相鄰格子，超出邊界或是牆回傳 NONE
+    auto neighborOf = [&](int cell, int i) {
+        int row = cell / cols, col = cell % cols;
+        switch (i) {
+            case 0:
+                return row > 0 && walkable[cell - cols] ? cell - cols : NONE;
+            case 1:
+                return row < rows - 1 && walkable[cell + cols] ? cell + cols : NONE;
+            case 2:
+                return col > 0 && walkable[cell - 1] ? cell - 1 : NONE;
+            default:
+                return col < cols - 1 && walkable[cell + 1] ? cell + 1 : NONE;
+        }
+    };
+
+    for (int cell = 0; cell < cellCount; cell++) {
+        topology[cell] = 0;
+        if (!walkable[cell])
+            continue;
+        for (int i = 0; i < 4; i++) {
+            if (neighborOf(cell, i) != NONE)
+                degree[cell]++;
+        }
+        if (degree[cell] <= 1)
+            queue.push_back(cell);
+    }
+
+    // 剝除死路末端，剝除後鄰格若也只剩一條出路則繼續剝除
+    for (size_t head = 0; head < queue.size(); head++) {
+        int cell = queue[head];
+        peeled[cell] = 1;
+        for (int i = 0; i < 4; i++) {
+            int next = neighborOf(cell, i);
+            if (next != NONE && !peeled[next] && --degree[next] == 1)
+                queue.push_back(next);
+        }
+    }
+
+    // 從剩餘主體出發做多源 BFS，得到每個死路格子距離出口的步數
+    std::vector<int> depth(cellCount, NONE);
+    queue.clear();
+    for (int cell = 0; cell < cellCount; cell++) {
+        if (walkable[cell] && !peeled[cell]) {
+            depth[cell] = 0;
+            queue.push_back(cell);
+        }
+    }
+    for (size_t head = 0; head < queue.size(); head++) {
+        int cell = queue[head];
+        for (int i = 0; i < 4; i++) {
+            int next = neighborOf(cell, i);
+            if (next != NONE && depth[next] == NONE) {
+                depth[next] = depth[cell] + 1;
+                queue.push_back(next);
+            }
+        }
+    }
+    for (int cell = 0; cell < cellCount; cell++) {
+        if (!walkable[cell])
+            continue;
+        // 整個連通區塊都是死路時沒有出口，視為最深
+        int cellDepth = depth[cell] == NONE ? TOPOLOGY_DEPTH_MASK : depth[cell];
+        topology[cell] = uint8_t(std::min(cellDepth, TOPOLOGY_DEPTH_MASK));
+    }
+
+    // 以明確堆疊進行 Tarjan 演算法找出關節點
+    std::vector<int> discover(cellCount, NONE);
+    std::vector<int> low(cellCount, 0);
+    std::vector<int> parent(cellCount, NONE);
+    std::vector<uint8_t> nextDirection(cellCount, 0);
+    std::vector<int> stack;
+    int timer = 0;
+
+    for (int root = 0; root < cellCount; root++) {
+        if (!walkable[root] || discover[root] != NONE)
+            continue;
+
+        int rootChildren = 0;
+        discover[root] = low[root] = timer++;
+        stack.push_back(root);
+
+        while (!stack.empty()) {
+            int cell = stack.back();
+
+            if (nextDirection[cell] < 4) {
+                int next = neighborOf(cell, nextDirection[cell]++);
+                if (next == NONE)
+                    continue;
+                if (discover[next] == NONE) {
+                    parent[next] = cell;
+                    discover[next] = low[next] = timer++;
+                    if (cell == root)
+                        rootChildren++;
+                    stack.push_back(next);
+                } else if (next != parent[cell]) {
+                    low[cell] = std::min(low[cell], discover[next]);
+                }
+                continue;
+            }
+
+            // 該格所有鄰格都處理完畢，回傳 low 值給父節點
+            stack.pop_back();
+            int up = parent[cell];
+            if (up == NONE)
+                continue;
+            low[up] = std::min(low[up], low[cell]);
+            if (up != root && low[cell] >= discover[up])
+                topology[up] |= TOPOLOGY_CUT_BIT;
+        }
+
+        if (rootChildren > 1)
+            topology[root] |= TOPOLOGY_CUT_BIT;
+    }
+}
+
+// 遊戲場座標對應到通道圖座標：第 3k+1、3k+2 格是第 k 個房間 (2k)，第 3k 格是房間之間的牆線 (2k-1)
+int corridorGraphCoordinate(int coordinate) {
+    int graph = coordinate % 3 == 0 ? coordinate / 3 * 2 - 1 : coordinate / 3 * 2;
+    return graph >= 0 && graph < CORRIDOR_GRAPH_SIDE ? graph : -1;
+}
+
+// 把迷宮的 2x2 房間、2 格寬的通道與柱子各縮成通道圖上的一格
+// 同一區的格子必須全是牆或全是通道、通道圖以外的邊界必須是牆，縮小後的連通關係才與原本相同
+bool collapseCorridors(GameField &field, uint8_t *walkable) {
+    const uint8_t UNSEEN = 2;
+    std::fill(walkable, walkable + CORRIDOR_GRAPH_SIDE * CORRIDOR_GRAPH_SIDE, UNSEEN);
+
+    for (int row = 0; row < GRID_SIDE; row++) {
+        int graphRow = corridorGraphCoordinate(row);
+        for (int col = 0; col < GRID_SIDE; col++) {
+            int graphCol = corridorGraphCoordinate(col);
+            uint8_t open = field[row][col] != WALL;
+            if (graphRow < 0 || graphCol < 0) {
+                if (open)
+                    return false;
+                continue;
+            }
+
+            uint8_t &cell = walkable[graphRow * CORRIDOR_GRAPH_SIDE + graphCol];
+            if (cell == UNSEEN)
+                cell = open;
+            else if (cell != open)
+                return false;
+        }
+    }
+    return true;
+}
+
+// 建立目前遊戲場的拓撲表
+// 生成的迷宮通道有 2 格寬，逐格分析時每個房間都是一個環，找不到死路也找不到關節點；
+// 這種迷宮改在縮小的通道圖上分析，再把結果對應回每一格，死路深度以經過的房間與通道數計算。
+// 預設地圖等無法縮小的遊戲場仍逐格分析
+void buildMazeTopology(GameSession &session, GameField &field) {
+    uint8_t corridors[CORRIDOR_GRAPH_SIDE * CORRIDOR_GRAPH_SIDE];
+    if (collapseCorridors(field, corridors)) {
+        uint8_t topology[CORRIDOR_GRAPH_SIDE * CORRIDOR_GRAPH_SIDE];
+        analyzeMazeTopology(corridors, CORRIDOR_GRAPH_SIDE, CORRIDOR_GRAPH_SIDE, topology);
+        for (int row = 0; row < GRID_SIDE; row++) {
+            int graphRow = corridorGraphCoordinate(row);
+            for (int col = 0; col < GRID_SIDE; col++) {
+                int graphCol = corridorGraphCoordinate(col);
+                session.mazeTopology[row][col] = graphRow < 0 || graphCol < 0 ? 0 :
+                                                 topology[graphRow * CORRIDOR_GRAPH_SIDE + graphCol];
+            }
+        }
+        session.topologyDirty = false;
+        return;
+    }
+
+    uint8_t walkable[GRID_SIDE * GRID_SIDE];
+    for (int row = 0; row < GRID_SIDE; row++) {
+        for (int col = 0; col < GRID_SIDE; col++) {
+            walkable[row * GRID_SIDE + col] = field[row][col] != WALL;
+        }
+    }
+
+    analyzeMazeTopology(walkable, GRID_SIDE, GRID_SIDE, &session.mazeTopology[0][0]);
+    session.topologyDirty = false;
+}
+
+// 牆壁改變時標記所有迷宮預先計算表需要重建
+void invalidateMazeTables(GameSession &session) {
+    invalidateWallPenaltyTable(session);
+    session.topologyDirty = true;
+    session.diffusionMaskDirty = true;
+}
+
+// 重建已失效的迷宮預先計算表
+void refreshMazeTables(GameSession &session, GameField &field) {
+    syncMazeTables(session, field);
+    if (session.wallTableDirty)
+        buildWallPenaltyTable(session, field);
+    if (session.topologyDirty)
+        buildMazeTopology(session, field);
+}
+
+// 依遊戲場的修改日誌更新牆壁相關的預先計算表
+// 牆壁沒有改變時只需要比較版本；牆壁改變時重播日誌，3x3 牆數逐格調整，
+// 拓撲與擴散遮罩牽動整個迷宮，直接標記為需要重建；日誌不足時全部重建
+void syncMazeTables(GameSession &session, GameField &field) {
+    if (session.mazeTablesVersion == field.version)
+        return;
+    if (field.wallVersion <= session.mazeTablesVersion && session.mazeTablesVersion <= field.version) {
+        session.mazeTablesVersion = field.version;
+        return;
+    }
+    if (!fieldJournalCovers(field, session.mazeTablesVersion)) {
+        invalidateMazeTables(session);
+        session.mazeTablesVersion = field.version;
+        return;
+    }
+
+    for (uint64_t version = session.mazeTablesVersion; version < field.version; version++) {
+        const FieldChange &change = fieldChange(field, version);
+        bool wasWall = change.oldValue == WALL;
+        bool isWall = change.newValue == WALL;
+        if (wasWall == isWall)
+            continue;
+
+        if (!session.wallTableDirty) {
+            int delta = isWall ? 1 : -1;
+            for (int row = std::max(change.row - 1, 0); row <= std::min(change.row + 1, GRID_SIDE - 1); row++) {
+                for (int col = std::max(change.col - 1, 0); col <= std::min(change.col + 1, GRID_SIDE - 1); col++) {
+                    int count = session.wallCount[row][col] + delta;
+                    session.wallCount[row][col] = count;
+                    session.wallPenalty[row][col] = sessionWallPenalty(session, count);
+                }
+            }
+        }
+        session.topologyDirty = true;
+        session.diffusionMaskDirty = true;
+    }
+    session.mazeTablesVersion = field.version;
+}
+
+// 查詢該格位在死路中的深度
+int deadEndDepth(GameSession &session, int row, int col) {
+    return session.mazeTopology[row][col] & TOPOLOGY_DEPTH_MASK;
+}
+
+// 查詢該格是否為關節點
+bool IsArticulationPoint(GameSession &session, int row, int col) {
+    return (session.mazeTopology[row][col] & TOPOLOGY_CUT_BIT) != 0;
+}
+
+// 擴散場單次 Jacobi 迭代：每格為來源加上四鄰平均的衰減值，牆與邊界由遮罩清為 0
+void diffusionStepScalar(const float *src, float *dst, const float *mask, const float *source, float decay) {
+    const float weight = decay * 0.25f;
+    for (int i = DIFFUSION_STRIDE; i < DIFFUSION_SIZE - DIFFUSION_STRIDE; i++) {
+        float sum = (src[i - DIFFUSION_STRIDE] + src[i + DIFFUSION_STRIDE]) + (src[i - 1] + src[i + 1]);
+        dst[i] = mask[i] * (source[i] + sum * weight);
+    }
+}
+
+#ifdef DIFFUSION_SIMD
+// 擴散場單次 Jacobi 迭代：SSE 版本，一次處理 4 格
+__attribute__((target("sse2")))
+void diffusionStepSse(const float *src, float *dst, const float *mask, const float *source, float decay) {
+    const __m128 weight = _mm_set1_ps(decay * 0.25f);
+    for (int i = DIFFUSION_STRIDE; i < DIFFUSION_SIZE - DIFFUSION_STRIDE; i += 4) {
+        __m128 vertical = _mm_add_ps(_mm_loadu_ps(src + i - DIFFUSION_STRIDE), _mm_loadu_ps(src + i + DIFFUSION_STRIDE));
+        __m128 horizontal = _mm_add_ps(_mm_loadu_ps(src + i - 1), _mm_loadu_ps(src + i + 1));
+        __m128 value = _mm_add_ps(_mm_loadu_ps(source + i), _mm_mul_ps(_mm_add_ps(vertical, horizontal), weight));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(mask + i), value));
+    }
+}
+
+// 擴散場單次 Jacobi 迭代：AVX2 版本，一次處理 8 格
+__attribute__((target("avx2")))
+void diffusionStepAvx2(const float *src, float *dst, const float *mask, const float *source, float decay) {
+    const __m256 weight = _mm256_set1_ps(decay * 0.25f);
+    for (int i = DIFFUSION_STRIDE; i < DIFFUSION_SIZE - DIFFUSION_STRIDE; i += 8) {
+        __m256 vertical = _mm256_add_ps(_mm256_loadu_ps(src + i - DIFFUSION_STRIDE),
+                                        _mm256_loadu_ps(src + i + DIFFUSION_STRIDE));
+        __m256 horizontal = _mm256_add_ps(_mm256_loadu_ps(src + i - 1), _mm256_loadu_ps(src + i + 1));
+        __m256 value = _mm256_add_ps(_mm256_loadu_ps(source + i),
+                                     _mm256_mul_ps(_mm256_add_ps(vertical, horizontal), weight));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(mask + i), value));
+    }
+}
+#endif
+
+// 依據 CPU 支援的指令集選擇擴散核心
+DiffusionKernel selectDiffusionKernel() {
+#ifdef DIFFUSION_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return diffusionStepAvx2;
+    if (__builtin_cpu_supports("sse2"))
+        return diffusionStepSse;
+#endif
+    return diffusionStepScalar;
+}
+
+// 計算等於 value 的格子數：純量版本
+int countCellsScalar(const uint8_t *cells, int size, uint8_t value) {
+    int count = 0;
+    for (int i = 0; i < size; i++) {
+        count += cells[i] == value;
+    }
+    return count;
+}
+
+// 找出第一個等於 value 的格子：純量版本
+int findCellScalar(const uint8_t *cells, int size, uint8_t value) {
+    for (int i = 0; i < size; i++) {
+        if (cells[i] == value)
+            return i;
+    }
+    return size;
+}
+
+// 把等於 value 的格子寫成位元遮罩：純量版本
+void maskCellsScalar(const uint8_t *cells, int size, uint8_t value, uint64_t *bits) {
+    std::fill(bits, bits + (size + 63) / 64, 0);
+    for (int i = 0; i < size; i++) {
+        bits[i / 64] |= uint64_t(cells[i] == value) << (i % 64);
+    }
+}
+
+#ifdef CELL_SCAN_SIMD
+// 計算等於 value 的格子數：SSE2 版本
+// 比較結果是 -1，以位元組減法累加，每 255 次以 SAD 加總到 64 位元，SSE2 不保證有 popcnt 指令
+__attribute__((target("sse2")))
+int countCellsSse2(const uint8_t *cells, int size, uint8_t value) {
+    const __m128i target = _mm_set1_epi8(char(value));
+    const __m128i zero = _mm_setzero_si128();
+    __m128i total = zero;
+    int i = 0;
+    while (i + 16 <= size) {
+        __m128i counts = zero;
+        for (int block = 0; block < 255 && i + 16 <= size; block++, i += 16) {
+            __m128i equal = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(cells + i)), target);
+            counts = _mm_sub_epi8(counts, equal);
+        }
+        total = _mm_add_epi64(total, _mm_sad_epu8(counts, zero));
+    }
+
+    uint64_t halves[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(halves), total);
+    return int(halves[0] + halves[1]) + countCellsScalar(cells + i, size - i, value);
+}
+
+// 找出第一個等於 value 的格子：SSE2 版本
+__attribute__((target("sse2")))
+int findCellSse2(const uint8_t *cells, int size, uint8_t value) {
+    const __m128i target = _mm_set1_epi8(char(value));
+    int i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i equal = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(cells + i)), target);
+        int found = _mm_movemask_epi8(equal);
+        if (found != 0)
+            return i + __builtin_ctz(found);
+    }
+    return i + findCellScalar(cells + i, size - i, value);
+}
+
+// 把等於 value 的格子寫成位元遮罩：SSE2 版本，每 16 格剛好是 64 位元字中的 16 個位元
+__attribute__((target("sse2")))
+void maskCellsSse2(const uint8_t *cells, int size, uint8_t value, uint64_t *bits) {
+    const __m128i target = _mm_set1_epi8(char(value));
+    std::fill(bits, bits + (size + 63) / 64, 0);
+    int i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i equal = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(cells + i)), target);
+        bits[i / 64] |= uint64_t(uint16_t(_mm_movemask_epi8(equal))) << (i % 64);
+    }
+    for (; i < size; i++) {
+        bits[i / 64] |= uint64_t(cells[i] == value) << (i % 64);
+    }
+}
+
+// 計算等於 value 的格子數：AVX2 版本
+__attribute__((target("avx2")))
+int countCellsAvx2(const uint8_t *cells, int size, uint8_t value) {
+    const __m256i target = _mm256_set1_epi8(char(value));
+    int count = 0;
+    int i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i equal = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(cells + i)), target);
+        count += __builtin_popcount(uint32_t(_mm256_movemask_epi8(equal)));
+    }
+    return count + countCellsScalar(cells + i, size - i, value);
+}
+
+// 找出第一個等於 value 的格子：AVX2 版本
+__attribute__((target("avx2")))
+int findCellAvx2(const uint8_t *cells, int size, uint8_t value) {
+    const __m256i target = _mm256_set1_epi8(char(value));
+    int i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i equal = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(cells + i)), target);
+        uint32_t found = uint32_t(_mm256_movemask_epi8(equal));
+        if (found != 0)
+            return i + __builtin_ctz(found);
+    }
+    return i + findCellScalar(cells + i, size - i, value);
+}
+
+// 把等於 value 的格子寫成位元遮罩：AVX2 版本
+__attribute__((target("avx2")))
+void maskCellsAvx2(const uint8_t *cells, int size, uint8_t value, uint64_t *bits) {
+    const __m256i target = _mm256_set1_epi8(char(value));
+    std::fill(bits, bits + (size + 63) / 64, 0);
+    int i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i equal = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(cells + i)), target);
+        bits[i / 64] |= uint64_t(uint32_t(_mm256_movemask_epi8(equal))) << (i % 64);
+    }
+    for (; i < size; i++) {
+        bits[i / 64] |= uint64_t(cells[i] == value) << (i % 64);
+    }
+}
+
+// 計算等於 value 的格子數：AVX-512 版本，比較結果直接是 64 位元遮罩
+__attribute__((target("avx512bw")))
+int countCellsAvx512(const uint8_t *cells, int size, uint8_t value) {
+    const __m512i target = _mm512_set1_epi8(char(value));
+    int count = 0;
+    int i = 0;
+    for (; i + 64 <= size; i += 64) {
+        count += __builtin_popcountll(_mm512_cmpeq_epi8_mask(_mm512_loadu_si512(cells + i), target));
+    }
+    return count + countCellsScalar(cells + i, size - i, value);
+}
+
+// 找出第一個等於 value 的格子：AVX-512 版本
+__attribute__((target("avx512bw")))
+int findCellAvx512(const uint8_t *cells, int size, uint8_t value) {
+    const __m512i target = _mm512_set1_epi8(char(value));
+    int i = 0;
+    for (; i + 64 <= size; i += 64) {
+        uint64_t found = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(cells + i), target);
+        if (found != 0)
+            return i + __builtin_ctzll(found);
+    }
+    return i + findCellScalar(cells + i, size - i, value);
+}
+
+// 把等於 value 的格子寫成位元遮罩：AVX-512 版本，每 64 格剛好寫一個字
+__attribute__((target("avx512bw")))
+void maskCellsAvx512(const uint8_t *cells, int size, uint8_t value, uint64_t *bits) {
+    const __m512i target = _mm512_set1_epi8(char(value));
+    int i = 0;
+    for (; i + 64 <= size; i += 64) {
+        bits[i / 64] = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(cells + i), target);
+    }
+    if (i < size) {
+        bits[i / 64] = 0;
+        for (; i < size; i++) {
+            bits[i / 64] |= uint64_t(cells[i] == value) << (i % 64);
+        }
+    }
+}
+#endif
+
+// 依據 CPU 支援的指令集選擇格子掃描核心
+CellScanKernels selectCellScanKernels() {
+#ifdef CELL_SCAN_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw"))
+        return {"avx512", countCellsAvx512, findCellAvx512, maskCellsAvx512};
+    if (__builtin_cpu_supports("avx2"))
+        return {"avx2", countCellsAvx2, findCellAvx2, maskCellsAvx2};
+    if (__builtin_cpu_supports("sse2"))
+        return {"sse2", countCellsSse2, findCellSse2, maskCellsSse2};
+#endif
+    return {"scalar", countCellsScalar, findCellScalar, maskCellsScalar};
+}
+
+// 取出位元遮罩中從第 start 位元開始的 count 個位元，跨越兩個字時把下一個字接上來
+uint64_t cellMaskBits(const uint64_t *bits, int start, int count) {
+    int word = start / 64;
+    int shift = start % 64;
+    uint64_t value = bits[word] >> shift;
+    if (shift + count > 64)
+        value |= bits[word + 1] << (64 - shift);
+    return value & ((uint64_t(1) << count) - 1);
+}
+
+// 擴散場中 (row, col) 的索引，四周各保留一格邊界
+int diffusionIndex(int row, int col) {
+    return (row + 1) * DIFFUSION_STRIDE + col + 1;
+}
+
+// 依據牆壁重建擴散場的可走遮罩
+void buildDiffusionMask(GameSession &session, GameField &field) {
+    std::fill(session.diffusionMask, session.diffusionMask + DIFFUSION_SIZE, 0.0f);
+    for (int row = 0; row < GRID_SIDE; row++) {
+        for (int col = 0; col < GRID_SIDE; col++) {
+            session.diffusionMask[diffusionIndex(row, col)] = field[row][col] == WALL ? 0.0f : 1.0f;
+        }
+    }
+    session.diffusionMaskDirty = false;
+}
+
+// 清空擴散場
+void resetDiffusionField(GameSession &session) {
+    resetScentField(session.resourceScent);
+    resetScentField(session.zombieScent);
+}
+
+// 清空單一氣味場
+void resetScentField(ScentField &scent) {
+    std::fill(&scent.value[0][0], &scent.value[0][0] + 2 * DIFFUSION_SIZE, 0.0f);
+    std::fill(scent.source, scent.source + DIFFUSION_SIZE, 0.0f);
+    scent.sourceCells.clear();
+    scent.current = 0;
+}
+
+// 只清除上回合放置過的來源
+void clearScentSources(ScentField &scent) {
+    for (int cell: scent.sourceCells) {
+        scent.source[cell] = 0.0f;
+    }
+    scent.sourceCells.clear();
+}
+
+// 在 (row, col) 放置氣味來源
+void addScentSource(ScentField &scent, int row, int col, float strength) {
+    int cell = diffusionIndex(row, col);
+    scent.source[cell] += strength;
+    scent.sourceCells.push_back(cell);
+}
+
+// 對氣味場進行固定次數的擴散迭代
+// 擴散場跨回合保留，所以每回合少量迭代就能逐漸收斂
+void diffuseScent(GameSession &session, ScentField &scent) {
+    for (int i = 0; i < DIFFUSION_ITERATIONS; i++) {
+        diffusionStep(scent.value[scent.current], scent.value[1 - scent.current],
+                      session.diffusionMask, scent.source, scent.decay);
+        scent.current = 1 - scent.current;
+    }
+}
+
+// 放置資源與喪屍的氣味來源，並進行固定次數的擴散迭代
+void updateDiffusionField(GameSession &session, GameField &field, const ZombieHorde &horde) {
+    syncMazeTables(session, field);
+    if (session.diffusionMaskDirty)
+        buildDiffusionMask(session, field);
+
+    clearScentSources(session.resourceScent);
+    clearScentSources(session.zombieScent);
+
+    for (int row = 0; row < GRID_SIDE; row++) {
+        for (int col = 0; col < GRID_SIDE; col++) {
+            if (field[row][col] == RESOURCE)
+                addScentSource(session.resourceScent, row, col, RESOURCE_SCENT);
+        }
+    }
+    for (int i = 0; i < hordeSize(horde); i++) {
+        addScentSource(session.zombieScent, horde.row[i], horde.col[i], ZOMBIE_SCENT);
+    }
+
+    diffuseScent(session, session.resourceScent);
+    diffuseScent(session, session.zombieScent);
+}
+
+// 擴散場生存者AI：在不會撞牆或靠近喪屍的相鄰格子中，選擇吸引與排斥氣味總和最強的方向
+Direction diffusionAI(GameSession &session, GameField &field,
+                      EntityPointer player,
+                      const ZombieHorde &horde) {
+    if (!session.tickPlanned)
+        updateDiffusionField(session, field, horde);
+
+    const float *attraction = session.resourceScent.value[session.resourceScent.current];
+    const float *repulsion = session.zombieScent.value[session.zombieScent.current];
+    Direction candidates[] = {UP, DOWN, RIGHT, LEFT};
+    Direction bestDirect = player->direct;
+    bool hasCandidate = false;
+    float bestScent = 0.0f;
+    int moves = safePlayerMoves(session, player, horde);
+
+    for (Direction direct: candidates) {
+        if (!(moves & (1 << direct)))
+            continue;
+
+        Location loc = nextStepLoc(player, direct);
+        int cell = diffusionIndex(loc.row, loc.col);
+        float scent = attraction[cell] + repulsion[cell];
+        if (!hasCandidate || scent > bestScent) {
+            hasCandidate = true;
+            bestScent = scent;
+            bestDirect = direct;
+        }
+    }
+
+    if (!hasCandidate)
+        return safeDirect(session, field, player, horde);
+
+    return bestDirect;
+}
+
+// 初始化 Zobrist 雜湊用的亂數表，使用固定種子讓雜湊值在每次執行時相同
+void initZobristKeys() {
+    std::mt19937_64 zobristGenerator(0x5eed2023);
+    for (int cell = 0; cell < GRID_SIDE * GRID_SIDE; cell++) {
+        zobristPlayer[cell] = zobristGenerator();
+        zobristZombie[cell] = zobristGenerator();
+        zobristResource[cell] = zobristGenerator();
+    }
+    zobristZombieTurn = zobristGenerator();
+}
+
+// 由目前遊戲狀態建立前瞻搜尋狀態，喪屍太多時只追蹤最接近生存者的 SEARCH_MAX_ZOMBIES 個
+SearchState makeSearchState(GameSession &session, GameField &field, EntityPointer player, const ZombieHorde &horde) {
+    SearchState state{};
+    state.playerRow = uint8_t(player->row);
+    state.playerCol = uint8_t(player->col);
+    state.step = session.stepCount;
+    state.hash = zobristPlayer[player->row * GRID_SIDE + player->col];
+    session.searchMoveInterval = sessionRules(session).zombieMoveInterval();
+    if (state.step % session.searchMoveInterval == 0)
+        state.hash ^= zobristZombieTurn;
+
+    // 喪屍依索引決定目標偏移量，先記錄下來再依距離挑選
+    std::vector<std::pair<int, int>> candidates;  // (距離, 喪屍索引)
+    std::vector<Location> positions;
+    for (int index = 0; index < hordeSize(horde); index++) {
+        positions.push_back({horde.row[index], horde.col[index]});
+        candidates.push_back({calculateDistance(player->row, player->col, horde.row[index], horde.col[index]), index});
+    }
+    std::sort(candidates.begin(), candidates.end());
+    if (candidates.size() > SEARCH_MAX_ZOMBIES)
+        candidates.resize(SEARCH_MAX_ZOMBIES);
+
+    session.searchZombieOffset.clear();
+    for (const auto &candidate: candidates) {
+        Location loc = positions[candidate.second];
+        state.zombieRow[state.zombieCount] = uint8_t(loc.row);
+        state.zombieCol[state.zombieCount] = uint8_t(loc.col);
+        state.hash ^= zobristZombie[loc.row * GRID_SIDE + loc.col];
+        session.searchZombieOffset.push_back(candidate.second * 2);
+        state.zombieCount++;
+    }
+
+    session.searchResources.clear();
+    for (int row = 0; row < GRID_SIDE; row++) {
+        for (int col = 0; col < GRID_SIDE; col++) {
+            if (field[row][col] == RESOURCE) {
+                session.searchResources.push_back({row, col});
+                state.hash ^= zobristResource[row * GRID_SIDE + col];
+            }
+        }
+    }
+
+    return state;
+}
+
+// 判斷前瞻搜尋中該格是否還有資源 (遊戲場上有資源且這條路線還沒收集)
+bool searchHasResource(GameField &field, const SearchState &state, int row, int col) {
+    if (field[row][col] != RESOURCE)
+        return false;
+    int cell = row * GRID_SIDE + col;
+    for (int i = 0; i < state.collectedCount; i++) {
+        if (state.collected[i] == cell)
+            return false;
+    }
+    return true;
+}
+
+// 模擬喪屍AI的下一步 (遊戲場版本)
+void modelZombieStep(GameField &field, int &row, int &col, Location target) {
+    greedyZombieStep([&field](int r, int c) { return IsAtWall(field, r, c); }, row, col, target);
+}
+
+// 模擬喪屍AI的下一步 (MCTS 模擬狀態版本)
+void modelZombieStep(const SimState &state, int &row, int &col, Location target) {
+    greedyZombieStep([&state](int r, int c) { return state.cells[r * GRID_SIDE + c] == WALL; }, row, col, target);
+}
+
+// 模擬喪屍AI的下一步：以 zombieFindPath 相同的鄰格順序，往目標曼哈頓距離最短的可走鄰格前進
+// 真正的喪屍AI是 A*，在開闊區域第一步與此相同，用來在搜尋中大量模擬
+template<typename WallTest>
+void greedyZombieStep(WallTest isWall, int &row, int &col, Location target) {
+    int iDir[] = {1, 0, -1, 0};
+    int jDir[] = {0, 1, 0, -1};
+    int bestRow = row, bestCol = col;
+    int bestSteps = calcSteps({row, col}, target);
+
+    for (int i = 0; i < 4; i++) {
+        int nextRow = row + iDir[i];
+        int nextCol = col + jDir[i];
+        if (isWall(nextRow, nextCol))
+            continue;
+        int steps = calcSteps({nextRow, nextCol}, target);
+        if (steps < bestSteps) {
+            bestSteps = steps;
+            bestRow = nextRow;
+            bestCol = nextCol;
+        }
+    }
+
+    row = bestRow;
+    col = bestCol;
+}
+
+// 前瞻搜尋的靜態評估：收集的資源越多越好，離最近資源越近越好，離喪屍太近扣分
+double evaluateSearchState(GameSession &session, GameField &field, const SearchState &state) {
+    double value = state.collectedCount * 1000.0;
+
+    int nearestResource = GRID_SIDE * 2;
+    for (const Location &resource: session.searchResources) {
+        if (searchHasResource(field, state, resource.row, resource.col))
+            nearestResource = std::min(nearestResource,
+                                       calculateDistance(state.playerRow, state.playerCol,
+                                                         resource.row, resource.col));
+    }
+    value -= nearestResource * 10.0;
+
+    for (int i = 0; i < state.zombieCount; i++) {
+        int distance = calculateDistance(state.playerRow, state.playerCol, state.zombieRow[i], state.zombieCol[i]);
+        if (distance <= DETECT_ZOMBIE_RANGE)
+            value -= (DETECT_ZOMBIE_RANGE - distance) * 5.0;
+    }
+
+    return value;
+}
+
+// expectimax 最大化節點：生存者嘗試四個方向，取期望值最高者
+double expectimaxMaxNode(GameSession &session, GameField &field, const SearchState &state, int depth) {
+    session.searchStats.nodes++;
+    if (depth == 0)
+        return evaluateSearchState(session, field, state);
+
+    // 每展開一定數量節點檢查一次時間預算，重播模式改用節點數預算
+    if (session.deterministic) {
+        if (session.searchStats.nodes >= SEARCH_NODE_BUDGET)
+            session.searchStats.aborted = true;
+    } else if ((session.searchStats.nodes & 255) == 0 && std::chrono::steady_clock::now() > session.searchDeadline)
+        session.searchStats.aborted = true;
+    if (session.searchStats.aborted)
+        return 0.0;
+
+    session.searchStats.probes++;
+    TranspositionEntry &entry = session.transpositionTable[state.hash & (TT_SIZE - 1)];
+    if (entry.generation == session.searchGeneration && entry.key == state.hash && entry.depth >= depth) {
+        session.searchStats.hits++;
+        return entry.value;
+    }
+
+    int iDir[] = {-1, 1, 0, 0};
+    int jDir[] = {0, 0, 1, -1};
+    double best = SEARCH_DEATH_VALUE * 2;
+
+    for (int i = 0; i < 4; i++) {
+        int row = state.playerRow + iDir[i];
+        int col = state.playerCol + jDir[i];
+        if (IsAtWall(field, row, col))
+            continue;
+
+        SearchState child = state;
+        child.playerRow = uint8_t(row);
+        child.playerCol = uint8_t(col);
+        child.hash ^= zobristPlayer[state.playerRow * GRID_SIDE + state.playerCol] ^
+                      zobristPlayer[row * GRID_SIDE + col];
+
+        // 走進喪屍所在格子就是被抓到，越晚被抓到越好
+        bool caught = false;
+        for (int z = 0; z < child.zombieCount; z++) {
+            if (child.zombieRow[z] == row && child.zombieCol[z] == col)
+                caught = true;
+        }
+        if (caught) {
+            best = std::max(best, SEARCH_DEATH_VALUE - depth);
+            continue;
+        }
+
+        if (child.collectedCount < SEARCH_MAX_COLLECTED && searchHasResource(field, child, row, col)) {
+            child.collected[child.collectedCount++] = uint16_t(row * GRID_SIDE + col);
+            child.hash ^= zobristResource[row * GRID_SIDE + col];
+        }
+
+        best = std::max(best, expectimaxChanceNode(session, field, child, depth));
+    }
+
+    if (!session.searchStats.aborted) {
+        entry.key = state.hash;
+        entry.value = best;
+        entry.depth = int8_t(depth);
+        entry.generation = session.searchGeneration;
+    }
+
+    return best;
+}
+
+// expectimax 機率節點：喪屍只在回合數是規則移動間隔倍數的回合移動，移動時以 ZOMBIE_ADVANCE_PROB 機率依模型前進，否則停留
+double expectimaxChanceNode(GameSession &session, GameField &field, const SearchState &state, int depth) {
+    SearchState hold = state;
+    bool zombieTurn = state.step % session.searchMoveInterval == 0;
+    hold.step++;
+    if (zombieTurn != (hold.step % session.searchMoveInterval == 0))
+        hold.hash ^= zobristZombieTurn;
+
+    if (!zombieTurn)
+        return expectimaxMaxNode(session, field, hold, depth - 1);
+
+    SearchState advance = hold;
+    Location target = {state.playerRow, state.playerCol};
+    bool caught = false;
+    for (int z = 0; z < advance.zombieCount; z++) {
+        int row = advance.zombieRow[z], col = advance.zombieCol[z];
+        modelZombieStep(field, row, col, {target.row + session.searchZombieOffset[z], target.col + session.searchZombieOffset[z]});
+        advance.hash ^= zobristZombie[advance.zombieRow[z] * GRID_SIDE + advance.zombieCol[z]] ^
+                        zobristZombie[row * GRID_SIDE + col];
+        advance.zombieRow[z] = uint8_t(row);
+        advance.zombieCol[z] = uint8_t(col);
+        if (row == target.row && col == target.col)
+            caught = true;
+    }
+
+    double advanceValue = caught ? SEARCH_DEATH_VALUE - depth : expectimaxMaxNode(session, field, advance, depth - 1);
+    double holdValue = expectimaxMaxNode(session, field, hold, depth - 1);
+    return ZOMBIE_ADVANCE_PROB * advanceValue + (1 - ZOMBIE_ADVANCE_PROB) * holdValue;
+}
+
+// expectimax 前瞻搜尋生存者AI：在時間預算內逐步加深搜尋，採用最後一個完整深度的結果
+Direction expectimaxAI(GameSession &session, GameField &field,
+                       EntityPointer player,
+                       const ZombieHorde &horde) {
+    using Clock = std::chrono::steady_clock;
+    auto begin = Clock::now();
+    session.searchDeadline = begin + std::chrono::microseconds(SEARCH_BUDGET_US);
+    session.searchStats = SearchStats{0, 0, 0, false};
+    if (session.transpositionTable.empty())
+        session.transpositionTable.assign(TT_SIZE, TranspositionEntry{0, 0.0, -1, 0});
+    // 雜湊值不含牆壁與喪屍的目標偏移量，搜尋值也依賴這次決策的根，所以每次決策都讓整個置換表失效；
+    // 迷宮重新生成一定發生在兩次決策之間，也一併處理
+    session.searchGeneration++;
+
+    SearchState root = makeSearchState(session, field, player, horde);
+    Direction directs[] = {UP, DOWN, RIGHT, LEFT};
+    int iDir[] = {-1, 1, 0, 0};
+    int jDir[] = {0, 0, 1, -1};
+    Direction bestDirect = safeDirect(session, field, player, horde);
+    int completedDepth = 0;
+
+    for (int depth = 1; depth <= SEARCH_MAX_DEPTH; depth++) {
+        Direction depthBest = bestDirect;
+        double depthBestValue = SEARCH_DEATH_VALUE * 2;
+
+        for (int i = 0; i < 4 && !session.searchStats.aborted; i++) {
+            int row = root.playerRow + iDir[i];
+            int col = root.playerCol + jDir[i];
+            if (IsAtWall(field, row, col) || IsAtZombie(horde, row, col))
+                continue;
+
+            SearchState child = root;
+            child.playerRow = uint8_t(row);
+            child.playerCol = uint8_t(col);
+            child.hash ^= zobristPlayer[root.playerRow * GRID_SIDE + root.playerCol] ^
+                          zobristPlayer[row * GRID_SIDE + col];
+            if (searchHasResource(field, child, row, col)) {
+                child.collected[child.collectedCount++] = uint16_t(row * GRID_SIDE + col);
+                child.hash ^= zobristResource[row * GRID_SIDE + col];
+            }
+
+            double value = expectimaxChanceNode(session, field, child, depth);
+            if (value > depthBestValue) {
+                depthBestValue = value;
+                depthBest = directs[i];
+            }
+        }
+
+        // 中途被時間預算中止的深度結果不完整，不採用
+        if (session.searchStats.aborted)
+            break;
+        bestDirect = depthBest;
+        completedDepth = depth;
+    }
+
+    double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    logSession(session, "Expectimax: depth %d, %lld nodes (%.0f nodes/s), TT hit rate %.1f%%\n",
+               completedDepth, session.searchStats.nodes, seconds > 0 ? session.searchStats.nodes / seconds : 0.0,
+               session.searchStats.probes > 0 ? 100.0 * session.searchStats.hits / session.searchStats.probes : 0.0);
+
+    return bestDirect;
+}
+
+// 由目前遊戲狀態建立 MCTS 模擬狀態，喪屍超過容量時只保留前段 (目標偏移量依索引而定)
+SimState makeSimState(GameSession &session, GameField &field, EntityPointer player, const ZombieHorde &horde) {
+    SimState state{};
+    for (int row = 0; row < GRID_SIDE; row++) {
+        for (int col = 0; col < GRID_SIDE; col++) {
+            state.cells[row * GRID_SIDE + col] = uint8_t(field[row][col]);
+        }
+    }
+    while (state.zombieCount < std::min(hordeSize(horde), MCTS_MAX_ZOMBIES)) {
+        state.zombieRow[state.zombieCount] = uint8_t(horde.row[state.zombieCount]);
+        state.zombieCol[state.zombieCount] = uint8_t(horde.col[state.zombieCount]);
+        state.zombieCount++;
+    }
+    state.playerRow = player->row;
+    state.playerCol = player->col;
+    state.step = session.stepCount;
+    state.score = session.scoreSum;
+    state.dead = false;
+
+    RuntimeRules rules = sessionRules(session);
+    state.zombieMoveInterval = rules.zombieMoveInterval();
+    state.zombieSpawnInterval = rules.zombieSpawnInterval();
+    state.resourceChance = rules.resourceChance();
+    state.perResourceKill = rules.perResourceKill();
+    return state;
+}
+
+// 在模擬狀態中隨機挑選不是牆也沒有喪屍的格子 (createResource 與 addZombie 的拒絕取樣)
+int simRandomFreeCell(const SimState &state, std::mt19937 &rng, bool avoidPlayer) {
+    while (true) {
+        int cell = int(rng() % (GRID_SIDE * GRID_SIDE));
+        if (state.cells[cell] == WALL)
+            continue;
+        if (avoidPlayer && cell == state.playerRow * GRID_SIDE + state.playerCol)
+            continue;
+        bool occupied = false;
+        for (int z = 0; z < state.zombieCount && !occupied; z++) {
+            occupied = state.zombieRow[z] * GRID_SIDE + state.zombieCol[z] == cell;
+        }
+        if (!occupied)
+            return cell;
+    }
+}
+
+// 依照 playGame 的順序模擬一個回合，不呼叫任何繪圖函式
+void simStep(SimState &state, Direction playerDirect, std::mt19937 &rng) {
+    // movePlayer
+    switch (playerDirect) {
+        case RIGHT:
+            state.playerCol++;
+            break;
+        case LEFT:
+            state.playerCol--;
+            break;
+        case UP:
+            state.playerRow--;
+            break;
+        case DOWN:
+            state.playerRow++;
+            break;
+    }
+
+    // 生存者走進喪屍所在格子 (包含交換位置) 視為被抓到
+    for (int z = 0; z < state.zombieCount; z++) {
+        if (state.zombieRow[z] == state.playerRow && state.zombieCol[z] == state.playerCol)
+            state.dead = true;
+    }
+
+    // controlZombieDirection + moveZombie
+    if (state.step % state.zombieMoveInterval == 0) {
+        for (int z = 0; z < state.zombieCount; z++) {
+            int row = state.zombieRow[z], col = state.zombieCol[z];
+            modelZombieStep(state, row, col, {state.playerRow + z * 2, state.playerCol + z * 2});
+            state.zombieRow[z] = uint8_t(row);
+            state.zombieCol[z] = uint8_t(col);
+        }
+    }
+
+    // addZombie
+    if (state.step % state.zombieSpawnInterval == 0 && state.zombieCount < MCTS_MAX_ZOMBIES) {
+        int cell = simRandomFreeCell(state, rng, true);
+        state.zombieRow[state.zombieCount] = uint8_t(cell / GRID_SIDE);
+        state.zombieCol[state.zombieCount] = uint8_t(cell % GRID_SIDE);
+        state.zombieCount++;
+    }
+
+    // playerCollectResource
+    int playerCell = state.playerRow * GRID_SIDE + state.playerCol;
+    if (state.cells[playerCell] == RESOURCE) {
+        state.cells[playerCell] = EMPTY;
+        state.score += scorePerResource;
+        state.cells[simRandomFreeCell(state, rng, false)] = RESOURCE;
+        if (state.score % state.perResourceKill == 0 && state.zombieCount > 1)
+            state.zombieCount--;
+    }
+
+    // IsGameOver
+    if (state.cells[playerCell] == WALL)
+        state.dead = true;
+    for (int z = 0; z < state.zombieCount; z++) {
+        if (state.zombieRow[z] == state.playerRow && state.zombieCol[z] == state.playerCol)
+            state.dead = true;
+    }
+
+    // 系統隨機產生資源
+    if (rng() % state.resourceChance == 0)
+        state.cells[simRandomFreeCell(state, rng, false)] = RESOURCE;
+
+    state.step++;
+}
+
+// 模擬回合中的隨機生存者策略：隨機選擇不會撞牆或撞到喪屍的方向
+Direction simRolloutDirect(const SimState &state, std::mt19937 &rng) {
+    Direction candidates[4];
+    int count = 0;
+    const Direction directs[] = {RIGHT, LEFT, UP, DOWN};
+    const int iDir[] = {0, 0, -1, 1};
+    const int jDir[] = {1, -1, 0, 0};
+
+    for (int i = 0; i < 4; i++) {
+        int row = state.playerRow + iDir[i];
+        int col = state.playerCol + jDir[i];
+        if (state.cells[row * GRID_SIDE + col] == WALL)
+            continue;
+        bool zombieThere = false;
+        for (int z = 0; z < state.zombieCount && !zombieThere; z++) {
+            zombieThere = state.zombieRow[z] == row && state.zombieCol[z] == col;
+        }
+        if (!zombieThere)
+            candidates[count++] = directs[i];
+    }
+
+    if (count == 0)
+        return directs[rng() % 4];
+    return candidates[rng() % count];
+}
+
+// 模擬狀態中生存者到最近資源的曼哈頓距離，沒有資源時回傳最大距離
+int simNearestResource(const SimState &state) {
+    int nearest = 2 * GRID_SIDE;
+    for (int cell = 0; cell < GRID_SIDE * GRID_SIDE; cell++) {
+        if (state.cells[cell] == RESOURCE)
+            nearest = std::min(nearest, calculateDistance(state.playerRow, state.playerCol,
+                                                          cell / GRID_SIDE, cell % GRID_SIDE));
+    }
+    return nearest;
+}
+
+// 單一執行緒的 MCTS 搜尋：以 UCB1 選擇，展開一個新動作後隨機模擬，直到時間截止或達到模擬次數上限
+MctsResult runMctsWorker(const SimState &root, unsigned seed, std::chrono::steady_clock::time_point deadline,
+                         long long rolloutLimit) {
+    const Direction directs[] = {RIGHT, LEFT, UP, DOWN};
+    std::mt19937 rng(seed);
+    std::vector<MctsNode> tree;
+    tree.reserve(1 << 16);
+    tree.push_back(MctsNode{{-1, -1, -1, -1}, 0, 0.0});
+
+    MctsResult result{};
+    std::vector<int> pathNodes;
+
+    while (true) {
+        // 每 16 次模擬檢查一次時間，減少讀取時鐘的成本
+        if ((result.rollouts & 15) == 0 && std::chrono::steady_clock::now() >= deadline)
+            break;
+        if (rolloutLimit > 0 && result.rollouts >= rolloutLimit)
+            break;
+
+        SimState state = root;
+        int node = 0;
+        pathNodes.clear();
+        pathNodes.push_back(node);
+        int startScore = state.score;
+        int depth = 0;
+
+        // 選擇與展開
+        while (!state.dead && depth < MCTS_ROLLOUT_DEPTH) {
+            int action = -1;
+            for (int i = 0; i < 4 && action < 0; i++) {
+                if (tree[node].children[i] < 0)
+                    action = i;
+            }
+
+            if (action >= 0) {
+                int child = int(tree.size());
+                tree.push_back(MctsNode{{-1, -1, -1, -1}, 0, 0.0});
+                tree[node].children[action] = child;
+                simStep(state, directs[action], rng);
+                node = child;
+                pathNodes.push_back(node);
+                depth++;
+                break;
+            }
+
+            double bestScore = -1.0;
+            for (int i = 0; i < 4; i++) {
+                const MctsNode &child = tree[tree[node].children[i]];
+                double mean = child.visits > 0 ? child.totalReward / child.visits : 0.0;
+                double explore = MCTS_EXPLORATION * sqrt(log(double(tree[node].visits + 1)) / (child.visits + 1));
+                if (mean + explore > bestScore) {
+                    bestScore = mean + explore;
+                    action = i;
+                }
+            }
+            simStep(state, directs[action], rng);
+            node = tree[node].children[action];
+            pathNodes.push_back(node);
+            depth++;
+        }
+
+        // 隨機模擬
+        while (!state.dead && depth < MCTS_ROLLOUT_DEPTH) {
+            simStep(state, simRolloutDirect(state, rng), rng);
+            depth++;
+        }
+
+        // 回報：存活給基本分，每收集一份資源加分，存活時越接近資源越好
+        double reward = 0.1 * std::min(state.score - startScore, 5);
+        if (!state.dead)
+            reward += 0.4 + 0.1 * (1.0 - simNearestResource(state) / (2.0 * GRID_SIDE));
+
+        for (int visited: pathNodes) {
+            tree[visited].visits++;
+            tree[visited].totalReward += reward;
+        }
+        result.rollouts++;
+    }
+
+    for (int i = 0; i < 4; i++) {
+        int child = tree[0].children[i];
+        if (child >= 0) {
+            result.rootVisits[i] = tree[child].visits;
+            result.rootReward[i] = tree[child].totalReward;
+        }
+    }
+    return result;
+}
+
+// 多執行緒 MCTS 生存者AI：每個執行緒各自建立搜尋樹 (根平行化)，最後合併根節點的拜訪次數
+Direction mctsAI(GameSession &session, GameField &field,
+                 EntityPointer player,
+                 const ZombieHorde &horde) {
+    using Clock = std::chrono::steady_clock;
+    const Direction directs[] = {RIGHT, LEFT, UP, DOWN};
+    auto begin = Clock::now();
+    auto deadline = begin + std::chrono::microseconds(MCTS_BUDGET_US);
+    long long rolloutLimit = 0;
+    if (session.deterministic) {
+        // 重播模式以固定的模擬次數取代時間預算，並只用一個執行緒，結果不受機器速度影響
+        deadline = Clock::time_point::max();
+        rolloutLimit = MCTS_ROLLOUT_BUDGET;
+    }
+
+    SimState root = makeSimState(session, field, player, horde);
+#ifdef SURVIVAL_THREADS
+    // 無介面模式由外部的執行緒池平行執行多個遊戲，每個遊戲只用一個執行緒
+    int threadCount = session.headless || session.deterministic ? 1 : int(std::min<unsigned>(std::max(std::thread::hardware_concurrency(), 1u),
+                                                                    MCTS_MAX_THREADS));
+#else
+    int threadCount = 1;  // 沒有執行緒支援時只在目前的執行緒搜尋
+#endif
+    std::vector<MctsResult> results(threadCount);
+
+#ifdef SURVIVAL_THREADS
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threadCount; i++) {
+        unsigned seed = nextRandom(session.random[RANDOM_SEARCH]);
+        workers.emplace_back([&results, &root, i, seed, deadline, rolloutLimit]() {
+            results[i] = runMctsWorker(root, seed, deadline, rolloutLimit);
+        });
+    }
+#endif
+    results[0] = runMctsWorker(root, nextRandom(session.random[RANDOM_SEARCH]), deadline, rolloutLimit);
+#ifdef SURVIVAL_THREADS
+    for (auto &worker: workers) {
+        worker.join();
+    }
+#endif
+
+    int visits[4] = {0};
+    double reward[4] = {0.0};
+    long long rollouts = 0;
+    for (const MctsResult &result: results) {
+        for (int i = 0; i < 4; i++) {
+            visits[i] += result.rootVisits[i];
+            reward[i] += result.rootReward[i];
+        }
+        rollouts += result.rollouts;
+    }
+
+    int best = -1;
+    for (int i = 0; i < 4; i++) {
+        Location loc = nextStepLoc(player, directs[i]);
+        if (IsAtWall(field, loc.row, loc.col) || visits[i] == 0)
+            continue;
+        if (best < 0 || visits[i] > visits[best])
+            best = i;
+    }
+
+    double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    logSession(session, "MCTS: %d threads, %lld rollouts (%.0f rollouts/s), best mean reward %.3f\n",
+               threadCount, rollouts, seconds > 0 ? rollouts / seconds : 0.0,
+               best >= 0 ? reward[best] / visits[best] : 0.0);
+
+    if (best < 0)
+        return safeDirect(session, field, player, horde);
+    return directs[best];
+}
+
+// 將 16 位元整數的位元分散到偶數位元：abcd -> 0a0b0c0d
+uint32_t spreadMortonBits(uint32_t value) {
+    value &= 0xFFFF;
+    value = (value | (value << 8)) & 0x00FF00FF;
+    value = (value | (value << 4)) & 0x0F0F0F0F;
+    value = (value | (value << 2)) & 0x33333333;
+    value = (value | (value << 1)) & 0x55555555;
+    return value;
+}
+
+// Morton 索引：col 佔偶數位元，row 佔奇數位元；索引只由座標決定，不需要邊長
+int64_t MortonLayout::index(int row, int col, int) {
+    return int64_t(spreadMortonBits(uint32_t(col))) | (int64_t(spreadMortonBits(uint32_t(row))) << 1);
+}
+
+// 分塊索引：先找出所在的塊，再加上塊內的列優先位置
+int64_t TiledLayout::index(int row, int col, int side) {
+    int64_t tile = int64_t(row / GRID_TILE_SIDE) * (side / GRID_TILE_SIDE) + col / GRID_TILE_SIDE;
+    return tile * GRID_TILE_SIDE * GRID_TILE_SIDE + (row % GRID_TILE_SIDE) * GRID_TILE_SIDE + col % GRID_TILE_SIDE;
+}
+
+// 清空快取模型
+void resetCacheModel(CacheModel &cache) {
+    for (uint64_t &tag: cache.tags) {
+        tag = 0;
+    }
+    cache.accesses = 0;
+    cache.misses = 0;
+}
+
+// 記錄一次記憶體存取：依位址決定快取行，存放的區塊不同就算一次失誤
+void touchCacheModel(CacheModel &cache, const void *address) {
+    uint64_t block = uint64_t(reinterpret_cast<uintptr_t>(address)) / CACHE_LINE_BYTES + 1;
+    uint64_t &tag = cache.tags[block % CACHE_MODEL_LINES];
+    cache.accesses++;
+    if (tag != block) {
+        tag = block;
+        cache.misses++;
+    }
+}
+
+// 初始化無限地圖，預先配置所有區塊位置，之後不再重新配置
+void initChunkedWorld(ChunkedWorld &world, uint64_t seed, size_t budget, const std::string &directory) {
+    world.seed = seed;
+    world.budget = std::max<size_t>(budget, 1);
+    world.directory = directory;
+    world.chunks.clear();
+    world.chunks.reserve(world.budget);
+    world.chunkSlot.clear();
+    world.clock = 0;
+    world.lastSlot = -1;
+    world.generated = 0;
+    world.loaded = 0;
+    world.evicted = 0;
+}
+
+// 區塊座標組成查表用的鍵值
+uint64_t chunkKey(int32_t chunkRow, int32_t chunkCol) {
+    return (uint64_t(uint32_t(chunkRow)) << 32) | uint32_t(chunkCol);
+}
+
+// 世界座標所在的區塊座標，負座標也要向下取整
+int32_t worldToChunk(int64_t coordinate) {
+    if (coordinate >= 0)
+        return int32_t(coordinate / CHUNK_SIDE);
+    return int32_t(-((-coordinate + CHUNK_SIDE - 1) / CHUNK_SIDE));
+}
+
+// 依世界種子與區塊座標生成區塊迷宮，做法與 generateMaze 相同：
+// 每 3 格一條格線，以 DFS 打通頂點之間的牆，再於上方與左方邊界開門連到相鄰區塊
+void generateWorldChunk(WorldChunk &chunk, uint64_t seed) {
+    // 以 splitmix64 混合種子與區塊座標，讓每個區塊有獨立且固定的亂數
+    uint64_t mixed = seed ^ chunkKey(chunk.chunkRow, chunk.chunkCol);
+    mixed += 0x9E3779B97F4A7C15ULL;
+    mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBULL;
+    mixed ^= mixed >> 31;
+    std::mt19937 chunkGenerator(uint32_t(mixed ^ (mixed >> 32)));
+
+    const int iDir[] = {-1, 1, 0, 0};
+    const int jDir[] = {0, 0, -1, 1};
+    uint8_t *cells = chunk.cells;
+    bool visited[CHUNK_VERTICES][CHUNK_VERTICES] = {};
+    std::vector<Location> stack;
+
+    // 初始化區塊為格線牆壁
+    for (int i = 0; i < CHUNK_SIDE; ++i) {
+        for (int j = 0; j < CHUNK_SIDE; ++j) {
+            cells[i * CHUNK_SIDE + j] = (i % 3 == 0 || j % 3 == 0) ? WALL : 0;
+        }
+    }
+
+    // 打掉頂點 (row, col) 往 direction 方向的牆
+    auto connect = [cells](Location vertex, int direction) {
+        int row = 1 + vertex.row * 3;
+        int col = 1 + vertex.col * 3;
+        for (int k = 0; k < 2; k++) {
+            switch (direction) {
+                case 0: cells[(row - 1) * CHUNK_SIDE + col + k] = 0; break;
+                case 1: cells[(row + 2) * CHUNK_SIDE + col + k] = 0; break;
+                case 2: cells[(row + k) * CHUNK_SIDE + col - 1] = 0; break;
+                default: cells[(row + k) * CHUNK_SIDE + col + 2] = 0; break;
+            }
+        }
+    };
+
+    // 以堆疊代替遞迴的 DFS，邊界的牆留給開門處理
+    Location first = {int(chunkGenerator() % CHUNK_VERTICES), int(chunkGenerator() % CHUNK_VERTICES)};
+    visited[first.row][first.col] = true;
+    stack.push_back(first);
+    while (!stack.empty()) {
+        Location vertex = stack.back();
+        int searchDirection = chunkGenerator() % 4;
+        bool advanced = false;
+
+        for (int i = 0; i < 4 && !advanced; i++) {
+            int direction = (searchDirection + i) % 4;
+            int row = vertex.row + iDir[direction];
+            int col = vertex.col + jDir[direction];
+            if (row < 0 || row >= CHUNK_VERTICES || col < 0 || col >= CHUNK_VERTICES)
+                continue;
+
+            if (!visited[row][col]) {
+                connect(vertex, direction);
+                visited[row][col] = true;
+                stack.push_back({row, col});
+                advanced = true;
+            } else if (chunkGenerator() % 5 == 0) {
+                connect(vertex, direction);
+            }
+        }
+        if (!advanced)
+            stack.pop_back();
+    }
+
+    // 上方與左方邊界開門，區塊本身連通，因此整個世界也連通
+    for (int door = 0; door < CHUNK_DOORS; door++) {
+        Location vertex = {0, int(chunkGenerator() % CHUNK_VERTICES)};
+        connect(vertex, 0);
+        vertex = {int(chunkGenerator() % CHUNK_VERTICES), 0};
+        connect(vertex, 2);
+    }
+
+    // 删除上下左右都為空的牆壁
+    for (int i = 1; i < CHUNK_SIDE - 1; i++) {
+        for (int j = 1; j < CHUNK_SIDE - 1; j++) {
+            if (cells[(i - 1) * CHUNK_SIDE + j] == 0 && cells[(i + 1) * CHUNK_SIDE + j] == 0 &&
+                cells[i * CHUNK_SIDE + j - 1] == 0 && cells[i * CHUNK_SIDE + j + 1] == 0) {
+                cells[i * CHUNK_SIDE + j] = 0;
+            }
+        }
+    }
+}
+
+// 區塊存檔的路徑
+std::string worldChunkPath(const ChunkedWorld &world, int32_t chunkRow, int32_t chunkCol) {
+    return world.directory + "/chunk_" + std::to_string(chunkRow) + "_" + std::to_string(chunkCol) + ".bin";
+}
+
+// 從磁碟讀回修改過的區塊
+bool loadWorldChunk(const ChunkedWorld &world, WorldChunk &chunk) {
+    if (world.directory.empty())
+        return false;
+
+    std::ifstream file(worldChunkPath(world, chunk.chunkRow, chunk.chunkCol), std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    file.read(reinterpret_cast<char *>(chunk.cells), sizeof(chunk.cells));
+    return bool(file);
+}
+
+// 將修改過的區塊寫到磁碟
+void saveWorldChunk(const ChunkedWorld &world, const WorldChunk &chunk) {
+    if (world.directory.empty()) {
+        // 沒有存檔資料夾時無法寫回，區塊下次會重新生成，修改會遺失
+        printf("Can't save chunk (%d, %d): the world has no directory, the changes are lost\n",
+               chunk.chunkRow, chunk.chunkCol);
+        return;
+    }
+
+    std::ofstream file(worldChunkPath(world, chunk.chunkRow, chunk.chunkCol), std::ios::binary);
+    if (file.is_open()) {
+        file.write(reinterpret_cast<const char *>(chunk.cells), sizeof(chunk.cells));
+    } else {
+        // 處理開啟失敗情況，修改會在區塊重新生成時遺失
+        printf("Can't save chunk (%d, %d)\n", chunk.chunkRow, chunk.chunkCol);
+    }
+}
+
+// 取得區塊：先看上次存取的區塊，再查表，都沒有時讀檔或生成
+WorldChunk &fetchWorldChunk(ChunkedWorld &world, int32_t chunkRow, int32_t chunkCol) {
+    world.clock++;
+    if (world.lastSlot >= 0) {
+        WorldChunk &last = world.chunks[world.lastSlot];
+        if (last.chunkRow == chunkRow && last.chunkCol == chunkCol) {
+            last.lastUsed = world.clock;
+            return last;
+        }
+    }
+
+    uint64_t key = chunkKey(chunkRow, chunkCol);
+    auto found = world.chunkSlot.find(key);
+    if (found != world.chunkSlot.end()) {
+        world.lastSlot = found->second;
+        world.chunks[found->second].lastUsed = world.clock;
+        return world.chunks[found->second];
+    }
+
+    // 超過上限時淘汰最久未用的區塊，修改過的先寫回磁碟
+    int slot;
+    if (world.chunks.size() < world.budget) {
+        slot = int(world.chunks.size());
+        world.chunks.emplace_back();
+    } else {
+        slot = 0;
+        for (int i = 1; i < int(world.chunks.size()); i++) {
+            if (world.chunks[i].lastUsed < world.chunks[slot].lastUsed)
+                slot = i;
+        }
+        WorldChunk &victim = world.chunks[slot];
+        if (victim.dirty)
+            saveWorldChunk(world, victim);
+        world.chunkSlot.erase(chunkKey(victim.chunkRow, victim.chunkCol));
+        world.evicted++;
+    }
+
+    WorldChunk &chunk = world.chunks[slot];
+    chunk.chunkRow = chunkRow;
+    chunk.chunkCol = chunkCol;
+    chunk.lastUsed = world.clock;
+    chunk.dirty = false;
+    if (loadWorldChunk(world, chunk)) {
+        world.loaded++;
+    } else {
+        generateWorldChunk(chunk, world.seed);
+        world.generated++;
+    }
+
+    world.chunkSlot[key] = slot;
+    world.lastSlot = slot;
+    return chunk;
+}
+
+// 取得無限地圖上的格子
+uint8_t worldCell(ChunkedWorld &world, WorldLocation location) {
+    int32_t chunkRow = worldToChunk(location.row);
+    int32_t chunkCol = worldToChunk(location.col);
+    WorldChunk &chunk = fetchWorldChunk(world, chunkRow, chunkCol);
+    int64_t row = location.row - int64_t(chunkRow) * CHUNK_SIDE;
+    int64_t col = location.col - int64_t(chunkCol) * CHUNK_SIDE;
+    return chunk.cells[row * CHUNK_SIDE + col];
+}
+
+// 修改無限地圖上的格子，並標記區塊需要寫回
+void setWorldCell(ChunkedWorld &world, WorldLocation location, uint8_t value) {
+    int32_t chunkRow = worldToChunk(location.row);
+    int32_t chunkCol = worldToChunk(location.col);
+    WorldChunk &chunk = fetchWorldChunk(world, chunkRow, chunkCol);
+    int64_t row = location.row - int64_t(chunkRow) * CHUNK_SIDE;
+    int64_t col = location.col - int64_t(chunkCol) * CHUNK_SIDE;
+    chunk.cells[row * CHUNK_SIDE + col] = value;
+    chunk.dirty = true;
+}
+
+// 以 A* 在無限地圖上搜尋路徑：節點以世界座標表示，格子透過 worldCell 取得，
+// 經過的區塊會自動生成，超過上限時淘汰最久未用的區塊，所以可以跨越任意多個區塊
+bool findWorldPath(ChunkedWorld &world, WorldLocation start, WorldLocation goal, std::vector<WorldLocation> &path) {
+    struct OpenNode {
+        int64_t cost;
+        int64_t step;
+        WorldLocation location;
+    };
+    auto worse = [](const OpenNode &a, const OpenNode &b) { return a.cost > b.cost; };
+    auto locationKey = [](WorldLocation location) {
+        return (uint64_t(uint32_t(location.row)) << 32) | uint32_t(location.col);
+    };
+    auto heuristic = [goal](WorldLocation location) {
+        return std::abs(location.row - goal.row) + std::abs(location.col - goal.col);
+    };
+    const int iDir[] = {-1, 1, 0, 0};
+    const int jDir[] = {0, 0, -1, 1};
+
+    std::vector<OpenNode> open;
+    std::unordered_map<uint64_t, int64_t> bestStep;
+    std::unordered_map<uint64_t, WorldLocation> cameFrom;
+    long long expanded = 0;
+
+    path.clear();
+    if (worldCell(world, start) == WALL || worldCell(world, goal) == WALL)
+        return false;
+
+    open.push_back({heuristic(start), 0, start});
+    bestStep[locationKey(start)] = 0;
+    while (!open.empty() && expanded < WORLD_SEARCH_LIMIT) {
+        std::pop_heap(open.begin(), open.end(), worse);
+        OpenNode current = open.back();
+        open.pop_back();
+        if (current.step != bestStep[locationKey(current.location)])
+            continue;
+
+        if (current.location.row == goal.row && current.location.col == goal.col) {
+            // 從終點沿著來源回溯到起點
+            WorldLocation location = goal;
+            path.push_back(location);
+            while (location.row != start.row || location.col != start.col) {
+                location = cameFrom[locationKey(location)];
+                path.push_back(location);
+            }
+            std::reverse(path.begin(), path.end());
+            return true;
+        }
+        expanded++;
+
+        for (int i = 0; i < 4; i++) {
+            WorldLocation next = {current.location.row + iDir[i], current.location.col + jDir[i]};
+            if (worldCell(world, next) == WALL)
+                continue;
+
+            uint64_t key = locationKey(next);
+            auto known = bestStep.find(key);
+            if (known != bestStep.end() && known->second <= current.step + 1)
+                continue;
+
+            bestStep[key] = current.step + 1;
+            cameFrom[key] = current.location;
+            open.push_back({current.step + 1 + heuristic(next), current.step + 1, next});
+            std::push_heap(open.begin(), open.end(), worse);
+        }
+    }
+    return false;
+}
+
+// 將無限地圖以 origin 為左上角的範圍複製到遊戲區域
+void copyWorldWindow(ChunkedWorld &world, WorldLocation origin, GameField &field) {
+    for (int i = 0; i < GRID_SIDE; i++) {
+        for (int j = 0; j < GRID_SIDE; j++) {
+            setFieldCell(field, i, j, worldCell(world, {origin.row + i, origin.col + j}) == WALL ? WALL : 0);
+        }
+    }
+}
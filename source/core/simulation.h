@@ -0,0 +1,1373 @@
+// 遊戲模擬核心：遊戲場、喪屍、生存者AI與回合邏輯，不依賴任何繪圖函式庫，
+// 畫面與鍵盤由前端透過 GameObserver 提供，沒有前端時即為無介面模擬
+#ifndef SURVIVAL_CORE_SIMULATION_H
+#define SURVIVAL_CORE_SIMULATION_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <fstream>
+#include <chrono>
+#include <cstdint>
+#include <cmath>
+#include <thread>
+#include <unordered_map>
+#include <string>
+#include <cstdarg>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <limits>
+
+// MinGW.org GCC 6.3 使用 win32 執行緒模型，標準函式庫沒有 std::thread、std::mutex 與 std::condition_variable，
+// 只有在標準函式庫支援執行緒時才使用多執行緒，否則全部在目前的執行緒執行
+#if !defined(__GLIBCXX__) || defined(_GLIBCXX_HAS_GTHREADS)
+#define SURVIVAL_THREADS 1
+#endif
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#include <immintrin.h>
+#define DIFFUSION_SIMD 1     // 編譯器支援以 target 屬性產生 SSE/AVX2 版本
+#define CELL_SCAN_SIMD 1     // 編譯器支援以 target 屬性產生 SSE2/AVX2/AVX-512 格子掃描版本
+#endif
+
+#define GRID_SIDE 40          // 設定遊戲方陣每邊格子數量
+#define RESOURCE_AMOUNT 1     // 設定每次產生資源數量
+#define PER_RESOURCE_KILL 5   // 設定多少資源數量可以殺掉一個喪屍
+#define INIT_SPEED 80         // 設定初始移動速度
+#define MAX_QUEUE_SIZE 1600   // 設定柱列大小
+#define ZOMBIE_POOL_CAPACITY 256  // 喪屍群預先保留的容量
+#define ZOMBIE_WAVE_SIZE 1        // 每次新增喪屍的數量
+#define RESOURCE_BUCKET_SIZE 8    // 資源索引每個桶子的邊長 (格)
+#define RESOURCE_BUCKETS ((GRID_SIDE + RESOURCE_BUCKET_SIZE - 1) / RESOURCE_BUCKET_SIZE) // 資源索引每邊的桶子數
+#define FIELD_STRIDE (GRID_SIDE + 2)           // 遊戲場每列的格數 (含左右哨兵)
+#define FIELD_SIZE (FIELD_STRIDE * FIELD_STRIDE) // 遊戲場總格數 (含上下哨兵)
+#define FIELD_JOURNAL_SIZE 256                 // 遊戲場修改日誌保留的修改數
+#define FIELD_MASK_WORDS ((FIELD_SIZE + 63) / 64) // 遊戲場每格一個位元的遮罩所需的 64 位元字數
+#define BITBOARD_ROW_MASK ((uint64_t(1) << GRID_SIDE) - 1) // 位元棋盤每列有效的位元
+#define DETECT_ZOMBIE_RANGE 8 // 玩家評估殭屍接近範圍
+#define MAX_EVAL_PATH 10      // 玩家建立評估路徑數量
+#define MAX_LEVEL 5           // 最高關卡數
+#define PASS_SCORE 5          // 基礎通關分數
+#define MAX_PASS_TIME 20      // 一關的通關時間 (second)
+#define INFLUENCE_KERNEL_SIZE (DETECT_ZOMBIE_RANGE * 2 + 1) // 喪屍影響範圍核心邊長
+#define WALL_PENALTY_THRESHOLD 3 // 周圍牆數超過此值才加上懲罰
+#define TOPOLOGY_CUT_BIT 0x80    // 拓撲表中標記關節點的位元
+#define TOPOLOGY_DEPTH_MASK 0x7F // 拓撲表中死路深度的位元
+#define CORRIDOR_GRAPH_SIDE ((GRID_SIDE - 1) / 3 * 2 - 1) // 迷宮縮成通道圖後每邊的格數：房間與通道交錯
+#define DEAD_END_PENALTY 10      // 每深入死路一步的懲罰
+#define CHOKE_POINT_PENALTY 20   // 喪屍附近關節點的懲罰
+#define DIFFUSION_STRIDE 48      // 擴散場每列的 float 數 (GRID_SIDE 加左右邊界後補齊到 8 的倍數)
+#define DIFFUSION_ROWS (GRID_SIDE + 2)                    // 擴散場列數 (含上下邊界)
+#define DIFFUSION_SIZE (DIFFUSION_ROWS * DIFFUSION_STRIDE) // 擴散場總格數
+#define DIFFUSION_ITERATIONS 8   // 每回合擴散迭代次數
+#define RESOURCE_SCENT 100.0f    // 資源的吸引強度
+#define RESOURCE_SCENT_DECAY 0.99f // 資源氣味每擴散一格的衰減，吸引力可以傳得很遠
+#define ZOMBIE_SCENT (-400.0f)   // 喪屍的排斥強度
+#define ZOMBIE_SCENT_DECAY 0.7f  // 喪屍氣味每擴散一格的衰減，只在附近產生排斥
+#define SEARCH_MAX_ZOMBIES 32    // 前瞻搜尋最多追蹤的喪屍數量 (取最接近的)
+#define SEARCH_MAX_COLLECTED 16  // 前瞻搜尋中一條路線最多記錄的已收集資源
+#define SEARCH_MAX_DEPTH 12      // 前瞻搜尋最大深度 (回合數)
+#define SEARCH_BUDGET_US 4000    // 每回合前瞻搜尋的時間預算 (微秒)
+#define SEARCH_NODE_BUDGET 50000 // 重播模式中每回合前瞻搜尋可展開的節點數，取代時間預算
+#define ZOMBIE_ADVANCE_PROB 0.8  // 機率節點中喪屍依模型前進的機率，其餘視為原地不動
+#define TT_BITS 16               // 置換表索引位元數
+#define TT_SIZE (1 << TT_BITS)   // 置換表大小
+#define SEARCH_DEATH_VALUE (-100000.0) // 被喪屍抓到的評估值
+#define MCTS_MAX_ZOMBIES 64      // MCTS 模擬狀態最多容納的喪屍數量
+#define MCTS_BUDGET_US 8000      // 每回合 MCTS 決策的時間預算 (微秒)
+#define MCTS_ROLLOUT_BUDGET 1000 // 重播模式中每回合 MCTS 的模擬次數，取代時間預算
+#define MCTS_MAX_THREADS 8       // MCTS 最多使用的執行緒數量
+#define MCTS_ROLLOUT_DEPTH 40    // 每次模擬最多進行的回合數
+#define MCTS_EXPLORATION 0.7     // UCB1 探索係數
+#define ZOMBIE_LOD_RANGE 12      // 超過此距離的喪屍視為遠方喪屍，使用簡化的AI
+#define ZOMBIE_LOD_INTERVAL 4    // 遠方喪屍每隔多少次喪屍回合才重新完整規劃路徑
+#define AI_TICK_BUDGET_US 3000   // 每回合喪屍規劃可使用的時間預算 (微秒)，不含生存者AI
+#define STALENESS_WEIGHT 4       // 排程優先度中每過期一回合等同拉近的距離
+#define CACHE_MODEL_LINES 512    // 快取模型的快取行數 (512 * 64 bytes = 32 KB，約為 L1 大小)
+#define CACHE_LINE_BYTES 64      // 快取行大小
+#define GRID_TILE_SIDE 8         // 分塊排列每塊的邊長
+#define CHUNK_SIDE 48                 // 無限地圖每個區塊的邊長，必須是 3 的倍數以延續迷宮格線
+#define CHUNK_VERTICES (CHUNK_SIDE / 3)  // 每個區塊迷宮頂點的列數與行數
+#define CHUNK_DOORS 2                 // 每個區塊上方與左方邊界開的門數
+#define WORLD_CHUNK_BUDGET 64         // 常駐記憶體的區塊數上限
+#define WORLD_SEARCH_LIMIT 200000     // 跨區塊 A* 最多展開的格子數
+#define TICK_RATE_WINDOW_MS 500       // 每隔多久更新一次每秒回合數 (毫秒)
+
+// 宣告前進方向列舉函數
+enum Direction {
+    RIGHT, LEFT, UP, DOWN
+};
+
+// 宣告生存者AI種類列舉函數
+enum PlayerAIMode {
+    AI_PATH_SEARCH,  // 評估多個資源的 A* 路徑
+    AI_DIFFUSION,    // 沿著擴散的氣味場前進
+    AI_EXPECTIMAX,   // 模擬喪屍回應的 expectimax 前瞻搜尋
+    AI_MCTS,         // 多執行緒蒙地卡羅樹搜尋
+    AI_MODE_COUNT
+};
+
+// 擴散場單次迭代的核心函數型別
+typedef void (*DiffusionKernel)(const float *src, float *dst, const float *mask, const float *source, float decay);
+
+// 整個遊戲場掃描的核心函數型別：計算等於 value 的格子數、找出第一個等於 value 的格子 (沒有時回傳 size)、
+// 把等於 value 的格子寫成位元遮罩 (第 i 格對應 bits[i / 64] 的第 i % 64 位元)
+typedef int (*CellCountKernel)(const uint8_t *cells, int size, uint8_t value);
+typedef int (*CellFindKernel)(const uint8_t *cells, int size, uint8_t value);
+typedef void (*CellMaskKernel)(const uint8_t *cells, int size, uint8_t value, uint64_t *bits);
+
+// 同一種指令集的一組格子掃描核心
+struct CellScanKernels {
+    const char *name;
+    CellCountKernel count;
+    CellFindKernel find;
+    CellMaskKernel mask;
+};
+
+// 定義擴散氣味場結構，吸引與排斥各用一個，才能有不同的擴散距離
+struct ScentField {
+    float value[2][DIFFUSION_SIZE];             // 擴散場雙緩衝
+    float source[DIFFUSION_SIZE];               // 每回合的氣味來源
+    int current;                                // 目前有效的緩衝
+    float decay;                                // 每擴散一格的衰減
+    std::vector<int> sourceCells;               // 上回合放置氣味來源的索引
+};
+
+// 宣告遊戲場出現物體列舉函數
+enum Object {
+    EMPTY,    // 空白
+    WALL,     // 牆或障礙物
+    RESOURCE  // 資原
+};
+
+// 定義遊戲場的一次修改
+struct FieldChange {
+    uint8_t row;       // 修改的格子
+    uint8_t col;
+    uint8_t oldValue;  // 修改前的物體
+    uint8_t newValue;  // 修改後的物體
+};
+
+// 定義遊戲場：每格一個位元組，外圍多一圈牆壁哨兵，整個遊戲場約 2 KB
+// row 或 col 為 -1 與 GRID_SIDE 時讀到的一定是牆，存取鄰格不需要檢查邊界
+// 所有修改都要經過 setFieldCell，每次修改版本加 1 並記錄到環狀日誌，
+// 衍生的預先計算表記住自己對應的版本，版本相同表示仍然有效，落後時重播日誌逐筆更新
+struct GameField {
+    uint8_t cells[FIELD_SIZE];                // 依 fieldIndex 排列的所有格子
+    uint64_t version = 0;                     // 修改次數
+    uint64_t wallVersion = 0;                 // 最後一次牆壁改變時的版本
+    uint64_t journalBase = 0;                 // 日誌能重播的最早版本，整個載入時會往後移
+    FieldChange journal[FIELD_JOURNAL_SIZE];  // 從版本 v 到 v + 1 的修改存放在 journal[v % FIELD_JOURNAL_SIZE]
+
+    // 回傳第 row 列第 0 格的位置，讓 field[row][col] 的讀取寫法維持不變，寫入請用 setFieldCell
+    const uint8_t *operator[](int row) const { return cells + (row + 1) * FIELD_STRIDE + 1; }
+};
+
+// 宣告生存者節點結構
+struct Entity {
+    int row;            // 節點位在第幾行
+    int col;            // 節點位在第幾列
+    Direction direct;   // 該節點的前進方向
+    struct Entity *next;  // 指向下一個節點
+    bool caught;        // 生存者這回合是否走進喪屍所在的格子
+};
+
+// 定義指向節點結構的指標變數
+typedef struct Entity *EntityPointer;
+
+static_assert(GRID_SIDE < 64, "bitboard rows must fit in a uint64_t");
+
+// 定義位元棋盤，每列一個 64 位元整數，第 col 個位元代表該列第 col 格
+// 整列一次處理，鄰格與交集等運算只需要少數幾個位元運算
+struct BitBoard {
+    uint64_t rows[GRID_SIDE];
+};
+
+// 定義遊戲狀態的位元平面
+struct GameBitboards {
+    BitBoard wall;      // 牆
+    BitBoard resource;  // 資源
+    BitBoard zombie;    // 有喪屍的格子
+    BitBoard player;    // 生存者
+};
+
+// 定義可放置格子的索引：不是牆也沒有喪屍的格子以密集陣列存放，並記錄每格在陣列中的位置，
+// 加入、移除與隨機挑選都是 O(1)
+struct FreeCellIndex {
+    std::vector<int> cells;                 // 可放置格子的編號 (row * GRID_SIDE + col)
+    int position[GRID_SIDE * GRID_SIDE];    // 各格在 cells 中的位置，-1 表示不在索引中
+    bool walkable[GRID_SIDE * GRID_SIDE];   // 各格是否不是牆
+};
+
+// 定義喪屍群結構，以陣列結構 (SoA) 連續存放所有喪屍，同一索引代表同一隻喪屍
+// 移除喪屍時把最後一隻搬到空出的位置，所以索引順序不固定；需要長期指向某隻喪屍時使用 ZombieHandle
+struct ZombieHorde {
+    std::vector<int> row;          // 各喪屍位在第幾行
+    std::vector<int> col;          // 各喪屍位在第幾列
+    std::vector<Direction> direct; // 各喪屍的前進方向
+    std::vector<int> planTick;     // 上次完整規劃路徑的喪屍回合
+    std::vector<int> slot;         // 各喪屍使用的槽位
+    std::vector<int> slotIndex;    // 各槽位目前對應的喪屍索引，-1 表示空槽
+    std::vector<int> generation;   // 各槽位的世代，槽位釋放時遞增，讓舊的 handle 失效
+    std::vector<int> freeSlots;    // 可重複使用的槽位
+    int occupancy[GRID_SIDE][GRID_SIDE] = {}; // 每格的喪屍數量，與遊戲場平行，查詢某格有沒有喪屍只需一次讀取
+    FreeCellIndex *freeCells = nullptr;       // 有設定時，格子有無喪屍改變會同步更新可放置格子索引
+    BitBoard zombieBits = {};                 // 有喪屍的格子的位元平面，與 occupancy 同步
+};
+
+// 定義指向某隻喪屍的 handle，喪屍被移除後 generation 不再相符
+struct ZombieHandle {
+    int slot;
+    int generation;
+};
+
+// 定義座標結構
+struct Location {
+    int row;
+    int col;
+};
+
+typedef struct PathNode *PathPointer;
+
+// 定義路徑節點結構，用來建立移動路徑
+struct PathNode {
+    int cost;   // 距離原點的步數
+    int steps;  // 距離目標的步數
+    Location loc;
+    PathPointer parent;
+    PathPointer next;
+};
+
+struct ResourceEvaluation {
+    Location resource;  // 資源的座標
+    int cost;      // 到達資源所需要的總成本
+};
+
+// 定義前瞻搜尋使用的精簡遊戲狀態，牆壁與資源直接讀取遊戲場
+struct SearchState {
+    uint8_t playerRow;                             // 生存者位置
+    uint8_t playerCol;
+    uint8_t zombieCount;                           // 追蹤的喪屍數量
+    uint8_t collectedCount;                        // 這條路線已收集的資源數量
+    uint8_t zombieRow[SEARCH_MAX_ZOMBIES];         // 喪屍位置
+    uint8_t zombieCol[SEARCH_MAX_ZOMBIES];
+    uint16_t collected[SEARCH_MAX_COLLECTED];      // 這條路線已收集的資源格子
+    int step;                                      // 回合數，決定喪屍這回合是否移動
+    uint64_t hash;                                 // Zobrist 雜湊值
+};
+
+// 定義置換表項目，搜尋值包含從這次決策的根收集到的資源，只在同一次決策中有效
+struct TranspositionEntry {
+    uint64_t key;          // 完整雜湊值，用來確認不是索引碰撞
+    double value;          // 搜尋結果
+    int8_t depth;          // 搜尋剩餘深度，-1 表示空項目
+    uint32_t generation;   // 寫入時的決策編號，與目前的決策不同時視為空項目
+};
+
+// 定義前瞻搜尋的統計資料
+struct SearchStats {
+    long long nodes;     // 展開節點數
+    long long probes;    // 置換表查詢次數
+    long long hits;      // 置換表命中次數
+    bool aborted;        // 是否因時間預算中止
+};
+
+// 定義 MCTS 使用的固定大小遊戲狀態，不含任何鏈結串列，可以直接複製
+struct SimState {
+    uint8_t cells[GRID_SIDE * GRID_SIDE];   // 遊戲場 (牆、資源、空白)
+    uint8_t zombieRow[MCTS_MAX_ZOMBIES];    // 喪屍位置，順序與喪屍群相同
+    uint8_t zombieCol[MCTS_MAX_ZOMBIES];
+    int zombieCount;                        // 喪屍數量
+    int playerRow;                          // 生存者位置
+    int playerCol;
+    int step;                               // 回合數
+    int score;                              // 分數
+    bool dead;                              // 生存者是否死亡
+    int zombieMoveInterval;                 // 這局遊戲的規則：喪屍每隔幾回合移動一次
+    int zombieSpawnInterval;                // 每隔幾回合新增喪屍
+    int resourceChance;                     // 每回合有 1 / resourceChance 的機率產生新資源
+    int perResourceKill;                    // 多少資源數量可以殺掉一個喪屍
+};
+
+// 定義 MCTS 樹節點，採用開環式搜尋：節點只記錄動作序列，狀態每次從根重新模擬
+struct MctsNode {
+    int children[4];     // 四個方向的子節點索引，-1 表示尚未展開
+    int visits;          // 拜訪次數
+    double totalReward;  // 累計回報
+};
+
+// 定義單一執行緒的 MCTS 結果
+struct MctsResult {
+    int rootVisits[4];       // 根節點四個方向的拜訪次數
+    double rootReward[4];    // 根節點四個方向的累計回報
+    long long rollouts;      // 完成的模擬次數
+};
+
+// 定義喪屍重新規劃的請求，priority 越小越先處理
+struct PlanRequest {
+    int priority;        // 距離減去過期回合的加權
+    int index;           // 喪屍在喪屍群中的索引，也用來計算目標偏移量
+};
+
+// 定義AI排程器的統計資料
+struct SchedulerStats {
+    int planned;         // 這回合完成的規劃數量
+    int backlog;         // 這回合沒有時間處理、延到下回合的規劃數量
+    long long overruns;  // 累計超出預算的回合數
+};
+
+// 定義資源的空間索引，遊戲場切成固定大小的桶子，每個桶子記錄其中的資源
+// 查詢時由生存者所在的桶子一圈一圈往外找，找到的資源夠近就不需要再擴大範圍
+struct ResourceIndex {
+    std::vector<int> bucket[RESOURCE_BUCKETS][RESOURCE_BUCKETS]; // 各桶子內資源的格子編號
+    int position[GRID_SIDE * GRID_SIDE];  // 各格在所屬桶子中的位置，-1 表示沒有資源
+    int count;                            // 資源總數
+    uint64_t version;                     // 索引對應的遊戲場版本
+};
+
+// 大型地圖的格子排列方式，提供相同的 cellCount 與 index 介面給 LayoutGrid 與路徑搜尋使用
+// 列優先排列：上下相鄰的格子相距一整列
+struct RowMajorLayout {
+    static const char *name() { return "row-major"; }
+    static int64_t cellCount(int side) { return int64_t(side) * side; }
+    static int64_t index(int row, int col, int side) { return int64_t(row) * side + col; }
+};
+
+// Z 字形 (Morton) 排列：交錯 row 與 col 的位元，鄰近的格子大多落在相近的位址，邊長必須是 2 的次方
+struct MortonLayout {
+    static const char *name() { return "morton"; }
+    static int64_t cellCount(int side) { return int64_t(side) * side; }
+    static int64_t index(int row, int col, int side);
+};
+
+// 分塊排列：每 8x8 格為一塊連續存放，塊與塊之間為列優先，邊長必須是 8 的倍數
+struct TiledLayout {
+    static const char *name() { return "tiled 8x8"; }
+    static int64_t cellCount(int side) { return int64_t(side) * side; }
+    static int64_t index(int row, int col, int side);
+};
+
+// 定義以指定排列方式存放的大型地圖
+template<typename Layout>
+struct LayoutGrid {
+    int side;                    // 地圖邊長
+    std::vector<uint8_t> cells;  // 依 Layout 排列的格子，1 表示可走
+};
+
+// 定義直接對應快取模型，用來估計存取模式造成的快取失誤
+struct CacheModel {
+    uint64_t tags[CACHE_MODEL_LINES];  // 每個快取行目前存放的位址區塊，0 表示空的
+    long long accesses;                // 存取次數
+    long long misses;                  // 失誤次數
+};
+
+// 定義無限地圖上的座標
+struct WorldLocation {
+    int64_t row;
+    int64_t col;
+};
+
+// 定義無限地圖的一個區塊
+struct WorldChunk {
+    int32_t chunkRow;                          // 區塊在世界中的列
+    int32_t chunkCol;                          // 區塊在世界中的行
+    uint8_t cells[CHUNK_SIDE * CHUNK_SIDE];    // 區塊內的格子，1 表示牆壁
+    uint64_t lastUsed;                         // 最後使用的時間，用於淘汰最久未用的區塊
+    bool dirty;                                // 是否被修改過，淘汰時需要寫回磁碟
+};
+
+// 定義由區塊組成的無限地圖，常駐的區塊數不超過 budget
+struct ChunkedWorld {
+    uint64_t seed;                                   // 世界種子，同一座標的區塊每次生成都相同
+    size_t budget;                                   // 常駐區塊數上限
+    std::string directory;                           // 修改過的區塊存放的資料夾，空字串表示不存檔
+    std::vector<WorldChunk> chunks;                  // 常駐的區塊
+    std::unordered_map<uint64_t, int> chunkSlot;     // 區塊座標對應到 chunks 的位置
+    uint64_t clock;                                  // 存取計數，作為最後使用時間
+    int lastSlot;                                    // 上次存取的區塊，連續存取同一區塊時不必查表
+    long long generated;                             // 生成的區塊數
+    long long loaded;                                // 從磁碟讀回的區塊數
+    long long evicted;                               // 淘汰的區塊數
+};
+
+// 遊戲規則的設定方式，提供相同的 side、perResourceKill 等介面給以規則為樣板參數的核心函數使用
+// 喪屍影響範圍決定了影響核心的大小 (INFLUENCE_KERNEL_SIZE)，只能在編譯期設定，不屬於規則
+// 預設的 40x40 規則：全部是編譯期常數，樣板以它實例化時迴圈邊界與索引計算都會被常數折疊
+struct ClassicRules {
+    static constexpr int side() { return GRID_SIDE; }                      // 遊戲方陣每邊格子數量
+    static constexpr int stride() { return GRID_SIDE + 2; }                // 每列的格數 (含左右哨兵)
+    static constexpr int maxEvalPath() { return MAX_EVAL_PATH; }           // 玩家建立評估路徑數量
+    static constexpr int perResourceKill() { return PER_RESOURCE_KILL; }   // 多少資源數量可以殺掉一個喪屍
+    static constexpr int wallPenaltyThreshold() { return WALL_PENALTY_THRESHOLD; } // 周圍牆數超過此值才加上懲罰
+    static constexpr int zombieMoveInterval() { return 2; }                // 喪屍每隔幾回合移動一次
+    static constexpr int zombieSpawnInterval() { return 30; }              // 每隔幾回合新增喪屍
+    static constexpr int resourceChance() { return 20; }                   // 每回合有 1 / resourceChance 的機率產生新資源
+};
+
+// 執行時設定的規則：預設值與 ClassicRules 相同，可以設定每一關不同的規則
+// 以規則為樣板參數的核心函數可以使用任意的地圖大小；遊戲場固定為 GRID_SIDE，所以 setSessionRules 只接受相同的大小
+// maxEvalPath 不能超過 MAX_EVAL_PATH
+struct RuntimeRules {
+    int sideValue = GRID_SIDE;
+    int maxEvalPathValue = MAX_EVAL_PATH;
+    int perResourceKillValue = PER_RESOURCE_KILL;
+    int wallPenaltyThresholdValue = WALL_PENALTY_THRESHOLD;
+    int zombieMoveIntervalValue = 2;
+    int zombieSpawnIntervalValue = 30;
+    int resourceChanceValue = 20;
+
+    int side() const { return sideValue; }
+    int stride() const { return sideValue + 2; }
+    int maxEvalPath() const { return maxEvalPathValue; }
+    int perResourceKill() const { return perResourceKillValue; }
+    int wallPenaltyThreshold() const { return wallPenaltyThresholdValue; }
+    int zombieMoveInterval() const { return zombieMoveIntervalValue; }
+    int zombieSpawnInterval() const { return zombieSpawnIntervalValue; }
+    int resourceChance() const { return resourceChanceValue; }
+};
+
+// 宣告單一回合結果列舉函數
+enum StepResult {
+    STEP_RUNNING,       // 遊戲繼續
+    STEP_TIME_UP,       // 關卡模式時間到仍未達到過關分數
+    STEP_LEVEL_PASSED,  // 關卡模式達到過關分數
+    STEP_CAUGHT         // 生存者撞牆或被喪屍抓到
+};
+
+// 宣告繪製格子時的物件列舉函數，實際顏色由前端決定
+enum CellPaint {
+    PAINT_EMPTY,     // 空白
+    PAINT_WALL,      // 牆
+    PAINT_RESOURCE,  // 資源
+    PAINT_SURVIVOR,  // 生存者
+    PAINT_ZOMBIE,    // 喪屍
+    PAINT_TARGET     // 生存者AI的循路目標
+};
+
+// 宣告各子系統使用的亂數串流列舉函數，同一局遊戲中每個子系統的亂數互不影響
+enum RandomSubsystem {
+    RANDOM_MAZE,           // 迷宮生成
+    RANDOM_RESOURCE,       // 資源位置
+    RANDOM_RESOURCE_ROLL,  // 每回合是否隨機產生資源
+    RANDOM_ZOMBIE,         // 喪屍出現位置
+    RANDOM_SQUAD,          // 小隊其他生存者的起點
+    RANDOM_SEARCH,         // MCTS 各執行緒的種子
+    RANDOM_STREAM_COUNT
+};
+
+// 定義以 Philox4x32-10 產生的亂數串流：第 n 個區塊只由種子、串流編號與 n 決定，不依賴前一個狀態，
+// 同一個種子可以切分出任意多條互不相關的串流，在哪個執行緒、以什麼順序執行都得到相同的亂數
+struct RandomStream {
+    uint32_t key[2];    // 金鑰，由種子決定
+    uint32_t stream;    // 串流編號
+    uint64_t counter;   // 下一個要產生的區塊
+    uint32_t block[4];  // 目前區塊的四個亂數
+    int used;           // 目前區塊已取出的亂數數量
+};
+
+struct GameObserver;
+
+// 定義一局遊戲的所有狀態，各局遊戲互不共用，同一個程式可以同時進行任意多局
+// 喪屍群指向自己的可放置格子索引，所以 GameSession 建立後不能複製或移動
+struct GameSession {
+    GameField field;                   // 遊戲場
+    ZombieHorde horde;                 // 喪屍群
+    std::vector<Entity> survivors;     // 還活著的生存者，第一位由鍵盤控制
+    int squadSize = 1;                 // 每關開始時的生存者數量
+    bool headless = false;             // 無介面模式：不輸出紀錄，MCTS 不另開執行緒
+    bool deterministic = false;        // 重播模式：以節點數與模擬次數取代時間預算，相同種子一定得到相同的遊戲
+    const GameObserver *observer = nullptr; // 繪製畫面與讀取鍵盤的前端，nullptr 表示不繪製也不讀取鍵盤
+    uint64_t seed = 0;                 // 這局遊戲的種子，以相同種子重新開始可以重播整局遊戲
+    RandomStream random[RANDOM_STREAM_COUNT]; // 各子系統的亂數串流，由 seed 切分
+
+    PathNode pathQueue[MAX_QUEUE_SIZE];  // 宣告將要拜訪的節點柱列
+    PathNode pathArena[MAX_QUEUE_SIZE];  // 已拜訪的路徑節點，路徑回傳後到下次搜尋前都有效
+    int pathArenaUsed = 0;               // 已使用的路徑節點數量
+    int front = -1;  // queue 第一個元素前一個位置
+    int rear = -1;   // queue 最後一個元素的位置
+
+    int speed = INIT_SPEED;            // 遊戲移動速度
+    int scoreSum = 0;                  // 紀錄分數
+    int killedCount = 0;               // 殺死喪屍數量
+    int totalTime = 0;                 // 紀錄遊戲時間
+    int stepCount = 0;                 // 步數計數器
+    std::chrono::steady_clock::time_point tickStart; // 這回合開始的時間
+    std::chrono::steady_clock::time_point zombiePlanStart; // 這回合喪屍開始規劃的時間，喪屍的時間預算由此起算
+    long long survivorPlanNs = 0;      // 累計生存者決策 (含共用規劃資料) 花費的時間 (奈秒)，不含喪屍規劃
+    std::chrono::steady_clock::time_point rateStart; // 這次量測回合速度開始的時間
+    int rateTicks = 0;                 // 這次量測已進行的回合數
+    double ticksPerSecond = 0;         // 最近量測到的每秒回合數
+    SchedulerStats schedulerStats = {0, 0, 0};   // AI排程器統計
+    bool IFPlayAI = true;              // 是否開啟AI模式
+    PlayerAIMode playerAIMode = AI_PATH_SEARCH; // 生存者AI種類
+    bool showTarget = true;            // 是否顯示循路目標
+    Location prevTarget = {0, 0};      // 紀錄上個循路位置
+    int found[13][13] = {{false}};     // 迷宮房間紀錄訪問
+    int level = 1;                     // 關卡數
+    int level_sum_score = PASS_SCORE;  // 過關所需分數
+    bool levelMode = true;             // 是否開啟關卡模式
+    bool customRules = false;          // 是否使用 rules，否則使用編譯期的 ClassicRules
+    RuntimeRules rules;                // 這局遊戲的執行時規則，地圖大小必須與遊戲場相同
+
+    int zombieInfluence[GRID_SIDE][GRID_SIDE] = {{0}}; // 所有喪屍疊加後的影響地圖
+    std::vector<Location> influenceStamps;             // 每個喪屍上次疊加核心的位置，與喪屍群索引相同
+    FreeCellIndex freeCellIndex;                       // 遊戲中不是牆也沒有喪屍的格子
+    ResourceIndex resourceIndex;                       // 遊戲中所有資源的空間索引
+
+    int wallCount[GRID_SIDE][GRID_SIDE];   // 每格周圍 3x3 的牆數
+    int wallPenalty[GRID_SIDE][GRID_SIDE]; // 每格的牆壁懲罰
+    bool wallTableDirty = true;            // 牆壁懲罰表是否需要重建
+    uint8_t mazeTopology[GRID_SIDE][GRID_SIDE]; // 每格的死路深度與關節點標記
+    uint64_t mazeTablesVersion = 0;             // 牆壁相關的預先計算表對應的遊戲場版本
+    bool topologyDirty = true;                  // 拓撲表是否需要重建
+
+    ScentField resourceScent = {{{0}}, {0}, 0, RESOURCE_SCENT_DECAY, {}}; // 資源的吸引氣味場
+    ScentField zombieScent = {{{0}}, {0}, 0, ZOMBIE_SCENT_DECAY, {}};     // 喪屍的排斥氣味場
+    float diffusionMask[DIFFUSION_SIZE];                 // 可走格子為 1，牆與邊界為 0
+    bool diffusionMaskDirty = true;                      // 擴散遮罩是否需要重建
+
+    // 每回合所有生存者共用的規劃資料，tickPlanned 為 true 時生存者AI直接讀取，不再各自重算
+    bool tickPlanned = false;                         // 這回合的共用規劃資料是否已準備好
+    GameBitboards tickBits;                           // 這回合由遊戲場轉換出的位元平面，生存者平面由各生存者自行設定
+    int survivorDistance[FIELD_SIZE];                 // 每格到最近生存者的步數，牆與走不到的格子為 -1
+    int survivorOwner[FIELD_SIZE];                    // 每格最近的生存者索引
+    int survivorQueue[FIELD_SIZE];                    // 多來源 BFS 的佇列
+
+    std::vector<TranspositionEntry> transpositionTable; // 置換表，第一次前瞻搜尋時才配置
+    uint32_t searchGeneration = 0;                    // 前瞻搜尋的決策編號，每次決策遞增，讓置換表中舊的項目失效
+    SearchStats searchStats;                          // 目前這次決策的搜尋統計
+    std::vector<int> searchZombieOffset;              // 每個追蹤喪屍的目標偏移量 (與 controlZombieDirection 相同)
+    int searchMoveInterval = 2;                       // 決策當下規則中喪屍每隔幾回合移動一次
+    std::vector<Location> searchResources;            // 決策當下的資源位置
+    std::chrono::steady_clock::time_point searchDeadline; // 前瞻搜尋的截止時間
+};
+
+// 定義遊戲畫面與輸入的觀察者，由前端提供，模擬核心只在狀態改變時通知，本身不依賴任何繪圖函式庫
+struct GameObserver {
+    void (*drawField)(GameSession &session);                                   // 重新繪製整個遊戲場
+    void (*drawCell)(GameSession &session, int row, int col, CellPaint paint); // 繪製一格
+    void (*showInfo)(GameSession &session);                                    // 顯示時間、分數等資訊
+    bool (*readDirection)(GameSession &session, Direction &direct);            // 讀取方向鍵，沒有輸入時回傳 false
+};
+
+#ifdef SURVIVAL_THREADS
+// 定義固定數量工作執行緒的執行緒池，沒有執行緒支援時不提供
+struct ThreadPool {
+    std::vector<std::thread> workers;         // 工作執行緒
+    std::deque<std::function<void()>> tasks;  // 等待執行的工作
+    std::mutex mutex;                         // 保護 tasks、running 與 stopping
+    std::condition_variable wake;             // 有新工作或要結束時通知工作執行緒
+    std::condition_variable idle;             // 所有工作都完成時通知等待的執行緒
+    int running = 0;                          // 正在執行的工作數
+    bool stopping = false;                    // 是否要結束所有工作執行緒
+};
+#endif
+
+// 輸出遊戲紀錄，無介面模式不輸出
+void logSession(GameSession &session, const char *format, ...);
+
+// 連接迷宮房間
+void connectVertex(GameField &field, Location vertex1, Location vertex2);
+
+// DFS 演算迷宮生成
+void vertexDfsVisit(GameSession &session, GameField &field, Location startVertex);
+
+// 生成迷宮
+void generateMaze(GameSession &session, GameField &field);
+
+// 建立一局遊戲：複製遊戲場並以種子設定各子系統的亂數串流
+void initSession(GameSession &session, const GameField &field, uint64_t seed, bool headless);
+
+// 以種子重設這局遊戲所有子系統的亂數串流
+void seedSessionRandom(GameSession &session, uint64_t seed);
+
+// Philox4x32-10 區塊函數：以 64 位元金鑰加密 128 位元計數器，得到四個 32 位元亂數
+void philoxBlock(const uint32_t key[2], const uint32_t counter[4], uint32_t out[4]);
+
+// 以種子與串流編號設定亂數串流，從第 0 個區塊開始
+void seedRandomStream(RandomStream &random, uint64_t seed, uint32_t stream);
+
+// 取出串流的下一個 32 位元亂數
+uint32_t nextRandom(RandomStream &random);
+
+// 取出 0 到 bound - 1 之間的亂數
+int randomBelow(RandomStream &random, int bound);
+
+// 由種子切分出第 index 個子種子，例如同時進行的多局遊戲各自使用一個
+uint64_t splitSeed(uint64_t seed, uint64_t index);
+
+// 回到第一關並清除分數與時間
+void resetSessionProgress(GameSession &session);
+
+// 開始一個關卡：重設生存者、喪屍群與索引，產生第一份資源
+void startGame(GameSession &session);
+
+// 進行一個回合，不處理延遲與鍵盤，回傳這回合的結果
+StepResult stepGame(GameSession &session);
+
+// 累計一個回合並每隔 TICK_RATE_WINDOW_MS 更新每秒回合數
+void updateTickRate(GameSession &session);
+
+// 設定這局遊戲之後的回合使用的規則，例如每一關不同的喪屍節奏、牆壁懲罰或評估路徑數量；
+// 地圖大小不是 GRID_SIDE 或數值超出範圍時不套用並回傳 false
+bool setSessionRules(GameSession &session, const RuntimeRules &rules);
+
+// 這局遊戲目前的規則，沒有自訂規則時為與 ClassicRules 相同的預設值
+RuntimeRules sessionRules(const GameSession &session);
+
+#ifdef SURVIVAL_THREADS
+// 啟動執行緒池
+void startThreadPool(ThreadPool &pool, int threadCount);
+
+// 等待所有工作完成後結束執行緒池
+void stopThreadPool(ThreadPool &pool);
+
+// 加入一個工作到執行緒池
+void submitTask(ThreadPool &pool, std::function<void()> task);
+
+// 等待執行緒池中所有工作完成
+void waitThreadPool(ThreadPool &pool);
+
+// 工作執行緒的主迴圈
+void threadPoolWorker(ThreadPool &pool);
+
+// 以執行緒池讓每局無介面遊戲各進行一個回合，結束的遊戲直接開始下一局，results 紀錄每局這回合的結果
+void stepSessions(ThreadPool &pool, std::vector<std::unique_ptr<GameSession>> &sessions,
+                  std::vector<StepResult> &results);
+#endif
+
+// 準備這回合所有生存者共用的喪屍影響地圖、危險位元平面與擴散場
+void prepareTickPlanning(GameSession &session);
+
+// 以所有生存者為來源做一次 BFS，每格記錄最近的生存者與步數，供喪屍選擇追蹤目標
+void updateSurvivorField(GameSession &session);
+
+// 移除撞牆或被抓到的生存者，回傳是否還有生存者
+bool removeDeadSurvivors(GameSession &session);
+
+//(生存者死亡條件：撞牆和撞到喪屍)
+bool IsGameOver(const ZombieHorde &horde,
+                EntityPointer player,
+                GameField &field);
+
+// 顯示遊戲相關資訊
+void showInfo(GameSession &session);
+
+// 繪製遊戲區域
+void drawGameField(GameSession &session);
+
+// 繪製方塊
+void drawSquare(GameSession &session, int row, int col, CellPaint paint);
+
+// 讀取AI輸入，並設定到所有喪屍節點，每個喪屍追蹤離它最近的生存者
+// moveInterval 是規則中喪屍每隔幾回合移動一次，用來換算喪屍規劃過期的回合數
+void controlZombieDirection(
+        GameSession &session,
+        GameField &field,
+        ZombieHorde &horde,
+        int moveInterval);
+
+// 讀取鍵盤方向輸入，或者AI輸入
+void controlPlayerDirection(
+        GameSession &session,
+        GameField &field,
+        EntityPointer player,
+        const ZombieHorde &horde);
+
+// 繪製喪屍群前進一步的改變
+void moveZombie(GameSession &session, GameField &field,
+                ZombieHorde &horde);
+
+// 依方向更新所有喪屍的位置，不做任何繪製
+void advanceZombies(ZombieHorde &horde);
+
+// 喪屍群的數量
+int hordeSize(const ZombieHorde &horde);
+
+// 在喪屍群尾端加入一隻喪屍，回傳它的 handle
+ZombieHandle spawnZombie(ZombieHorde &horde, int row, int col, Direction direct);
+
+// 移除第 index 隻喪屍，以最後一隻喪屍填補空位
+void removeZombie(ZombieHorde &horde, int index);
+
+// 以 handle 移除喪屍，handle 已失效時不做任何事
+void despawnZombie(ZombieHorde &horde, ZombieHandle handle);
+
+// 查詢 handle 目前對應的喪屍索引，已失效回傳 -1
+int zombieIndex(const ZombieHorde &horde, ZombieHandle handle);
+
+// 預先保留喪屍群的容量
+void initHorde(ZombieHorde &horde);
+
+// 清空喪屍群但保留已配置的容量，重新開始關卡時使用
+void resetHorde(ZombieHorde &horde);
+
+// 某格增加或減少一隻喪屍，並在格子變成有或沒有喪屍時更新可放置格子索引
+void occupyCell(ZombieHorde &horde, int row, int col);
+void vacateCell(ZombieHorde &horde, int row, int col);
+
+// 位元棋盤的基本操作，超出遊戲場的座標視為沒有設定
+void setBit(BitBoard &board, int row, int col);
+void clearBit(BitBoard &board, int row, int col);
+bool testBit(const BitBoard &board, int row, int col);
+
+// 位元棋盤的集合運算
+BitBoard bitboardAnd(const BitBoard &a, const BitBoard &b);
+BitBoard bitboardOr(const BitBoard &a, const BitBoard &b);
+BitBoard bitboardAndNot(const BitBoard &a, const BitBoard &b);
+bool bitboardAny(const BitBoard &board);
+int bitboardCount(const BitBoard &board);
+
+// 位元棋盤往上下左右擴張一格 (包含原本的格子)
+BitBoard dilateBitboard(const BitBoard &board);
+
+// 喪屍所在與相鄰的格子，也就是 IsCloseZombie 成立的所有格子
+BitBoard zombieDanger(const ZombieHorde &horde);
+
+// 由遊戲場、喪屍群與生存者建立位元平面，player 為 nullptr 時生存者平面為空
+void fieldToBitboards(GameField &field, const ZombieHorde &horde, EntityPointer player, GameBitboards &bits);
+
+// 由位元平面寫回遊戲場 (牆與資源)
+void bitboardsToField(const GameBitboards &bits, GameField &field);
+
+// 生存者四個方向中，不會撞牆也不會靠近喪屍的方向
+int safePlayerMoves(GameSession &session, EntityPointer player, const ZombieHorde &horde);
+
+// 依遊戲場與喪屍群重建可放置格子索引
+void buildFreeCellIndex(FreeCellIndex &index, GameField &field, const ZombieHorde &horde);
+
+// 將格子加入或移出可放置格子索引，牆壁不會被加入
+void addFreeCell(FreeCellIndex &index, int cell);
+void removeFreeCell(FreeCellIndex &index, int cell);
+
+// 隨機挑選一個可放置的格子，沒有可用格子時回傳 -1
+int randomFreeCell(RandomStream &random, const FreeCellIndex &index);
+
+// 以部分 Fisher-Yates 洗牌隨機挑選不重複的可放置格子
+void pickFreeCells(RandomStream &random, FreeCellIndex &index, int count, std::vector<int> &picked);
+
+// 一次新增一波喪屍，不會出現在牆、其他喪屍或生存者的位置
+void spawnZombieWave(GameSession &session, ZombieHorde &horde, const Entity *survivors, int survivorCount, int count,
+                     Direction direct);
+
+// 繪製生存者前進一步的改變
+void movePlayer(GameSession &session, EntityPointer player);
+
+// 產生資源
+void createResource(GameSession &session, GameField &field, const ZombieHorde &horde);
+
+// 判斷是否撞到牆
+bool IsAtWall(GameField &field, int row, int col);
+
+// 遊戲場中 (row, col) 的線性索引，row 與 col 可以是 -1 到 GRID_SIDE
+int fieldIndex(int row, int col);
+
+// 由整數地圖載入遊戲場，並設定外圍的牆壁哨兵
+void loadGameField(GameField &field, const int map[][GRID_SIDE]);
+
+// 修改遊戲場的格子，版本加 1 並記錄到修改日誌，值沒有改變時不記錄
+void setFieldCell(GameField &field, int row, int col, uint8_t value);
+
+// 日誌是否還保留從 version 到目前版本的所有修改
+bool fieldJournalCovers(const GameField &field, uint64_t version);
+
+// 從版本 version 到 version + 1 的修改
+const FieldChange &fieldChange(const GameField &field, uint64_t version);
+
+// 判斷是否撞到喪屍的身體
+bool IsAtZombie(const ZombieHorde &horde,
+                int row,
+                int col);
+
+// 判斷是否撞到喪屍
+bool IsCloseZombie(const ZombieHorde &horde, int row, int col);
+
+// 某格的喪屍數量，超出遊戲場視為沒有喪屍
+int zombiesAt(const ZombieHorde &horde, int row, int col);
+
+// 處理生存者收集到資源邏輯，每收集 perResourceKill 份資源殺掉一個喪屍
+void playerCollectResource(GameSession &session, GameField &field,
+                           EntityPointer player,
+                           ZombieHorde &horde,
+                           int perResourceKill);
+
+// 增加喪屍數量
+void addZombie(GameSession &session, ZombieHorde &horde);
+
+// 隨機殺掉一個喪屍
+void killZombie(GameSession &session, ZombieHorde &horde);
+
+// 計算下一步的座標
+Location nextStepLoc(EntityPointer node, Direction direct);
+Location nextStepLoc(Location loc, Direction direct);
+
+// 掃描整個遊戲場尋找最接近第 K 的資源的座標 (未使用資源索引的版本)
+Location findNearestKthResource(GameField &field, EntityPointer me, int k);
+
+// 依遊戲場重建資源索引
+void buildResourceIndex(ResourceIndex &index, GameField &field);
+
+// 依遊戲場的修改日誌更新資源索引，日誌不足時重建
+void syncResourceIndex(ResourceIndex &index, GameField &field);
+
+// 將資源加入或移出資源索引
+void addResource(ResourceIndex &index, int row, int col);
+void removeResource(ResourceIndex &index, int row, int col);
+
+// 一次找出離指定座標最近的 k 個資源，依曼哈頓距離由近到遠存入 nearest
+void findNearestResources(const ResourceIndex &index, Location from, int k, std::vector<Location> &nearest);
+
+// 生存者如果無法找到有效路徑，暫時決定一個安全方向
+Direction safeDirect(GameSession &session, GameField &field,
+                     EntityPointer player,
+                     const ZombieHorde &horde);
+
+// 喪屍如果無法找到有效路徑，暫時決定一個安全方向
+Direction safeDirect4Zombie(GameField &field, const ZombieHorde &horde, int index);
+
+// 遠方喪屍的簡化AI：直接往目標走一步，不做完整的路徑搜尋
+Direction greedyZombieDirect(GameField &field, const ZombieHorde &horde, int index, Location target);
+
+// 這回合喪屍規劃還剩下多少時間預算 (微秒)
+long long remainingTickBudget(GameSession &session);
+
+// 喪屍尋找兩點之間可到達的路徑，不需考慮會不會撞到其他喪屍或者生存者，只需考慮不能撞到牆
+PathPointer zombieFindPath(GameSession &session, GameField &field,
+                           Location startLoc,
+                           Location goalLoc);
+
+// 生存者尋找兩點之間可到達的路徑，必須考慮不能撞到喪屍或者牆
+PathPointer playerFindPath(GameSession &session, GameField &field,
+                           Location startLoc,
+                           Location goalLoc,
+                           const ZombieHorde &horde);
+
+// 路徑柱列處理
+void addPathQueue(GameSession &session, PathNode pathNode);   // 將之後要拜訪的節點放入佇列裡
+PathPointer popPathQueue(GameSession &session);             // 傳回路徑佇列中的元素，並將它從佇列中刪除
+bool isPathQueueEmpty(GameSession &session);                // 判斷佇列是否為空
+void resetPathQueue(GameSession &session);                  // 重設佇列
+void sortPathQueue(GameSession &session);                   // 對佇列中的元素進行排序
+bool IsInPathQueue(GameSession &session, PathNode pathNode);  // 判斷該元素是否在佇列之中
+
+// 回傳到目標位置的路徑串列
+PathPointer buildPath(PathPointer goal);
+
+// 每次路徑搜尋開始時回收所有路徑節點
+void resetPathArena(GameSession &session);
+
+// 計算兩點之間需要移動的步數
+int calcSteps(Location start, Location goal);
+
+// 判斷是否該節點已經拜訪過
+bool visited(GameSession &session, Location loc);
+
+// 從路徑資料判斷下一步方向
+Direction getDirectionByPath(Location start,
+                             Direction direct,
+                             PathPointer path);
+
+// 喪屍AI
+Direction zombieAI(GameSession &session, GameField &field,
+                   const ZombieHorde &horde,
+                   int index,
+                   Location target);
+
+// 生存者AI
+Direction playerAI(GameSession &session, GameField &field,
+                   EntityPointer player,
+                   const ZombieHorde &horde);
+
+// 評估前往最佳地點
+Location evalBestLocation(GameSession &session, GameField &field, EntityPointer player, const ZombieHorde &horde);
+
+// 計算到達指定資源花費
+ResourceEvaluation evalResourceCost(GameSession &session, GameField &field, EntityPointer player, const ZombieHorde &horde, Location resource);
+
+// 計算路徑花費
+int pathCost(PathPointer path);
+
+// 計算距離
+int calculateDistance(int row, int col, int row1, int col1);
+
+// 預先計算喪屍影響範圍的菱形核心
+void initInfluenceKernel();
+
+// 以喪屍位置為中心疊加 (sign = 1) 或移除 (sign = -1) 影響核心
+void stampZombieInfluence(GameSession &session, Location center, int sign);
+
+// 每回合更新喪屍影響地圖，只重新疊加有移動的喪屍
+void updateZombieInfluence(GameSession &session, const ZombieHorde &horde);
+
+// 清空喪屍影響地圖
+void resetZombieInfluence(GameSession &session);
+
+// 建立每格周圍 3x3 的牆數與懲罰表
+void buildWallPenaltyTable(GameSession &session, GameField &field);
+
+// 牆壁改變時標記牆壁懲罰表需要重建
+void invalidateWallPenaltyTable(GameSession &session);
+
+// 直接掃描 3x3 範圍計算牆壁懲罰 (未使用預先計算表的版本)
+int scanWallPenalty(GameField &field, int row, int col);
+
+// 依這局遊戲的規則計算周圍有 count 面牆的格子的牆壁懲罰
+int sessionWallPenalty(const GameSession &session, int count);
+
+// 周圍 3x3 有 count 面牆的格子的牆壁懲罰
+template<typename Rules>
+int rulesWallPenalty(const Rules &rules, int count);
+
+// 規則所定大小、外圈為哨兵牆的遊戲場中 (row, col) 的索引
+template<typename Rules>
+int rulesCellIndex(const Rules &rules, int row, int col);
+
+// 依規則建立每格周圍 3x3 的牆數與懲罰表，cells 含哨兵，wallCount 與 wallPenalty 為 side * side 的列優先陣列
+template<typename Rules>
+void buildRulesWallTable(const Rules &rules, const uint8_t *cells, int *wallCount, int *wallPenalty);
+
+// 依規則從多個來源格子做四方向 BFS，distance 寫入每格到最近來源的步數，牆與走不到的格子為 -1
+// owner 不為 nullptr 時寫入每格最近來源在 sources 中的索引
+// cells、distance、owner 與 queue 都是含哨兵的 stride * stride 陣列，回傳展開的格子數
+template<typename Rules>
+int rulesBreadthFirst(const Rules &rules, const uint8_t *cells, const int *sources, int sourceCount,
+                      int *distance, int *owner, int *queue);
+
+// 分析任意大小迷宮的死路深度與關節點，結果寫入每格一個位元組的拓撲表
+void analyzeMazeTopology(const uint8_t *walkable, int rows, int cols, uint8_t *topology);
+
+// 遊戲場座標對應到通道圖座標：房間的兩格縮成一格，中間的牆線 (通道或柱子) 縮成一格，超出範圍回傳 -1
+int corridorGraphCoordinate(int coordinate);
+
+// 把迷宮的房間、通道與柱子各縮成一格，每一區都只有牆或通道時回傳 true
+bool collapseCorridors(GameField &field, uint8_t *walkable);
+
+// 建立目前遊戲場的拓撲表
+void buildMazeTopology(GameSession &session, GameField &field);
+
+// 牆壁改變時標記所有迷宮預先計算表需要重建
+void invalidateMazeTables(GameSession &session);
+
+// 重建已失效的迷宮預先計算表
+void refreshMazeTables(GameSession &session, GameField &field);
+
+// 依遊戲場的修改日誌更新牆壁相關的預先計算表，牆壁位元平面與懲罰表逐格更新，其餘標記為需要重建
+void syncMazeTables(GameSession &session, GameField &field);
+
+// 查詢該格位在死路中的深度，0 表示不在死路中
+int deadEndDepth(GameSession &session, int row, int col);
+
+// 查詢該格是否為關節點 (移除後通道會被切斷)
+bool IsArticulationPoint(GameSession &session, int row, int col);
+
+// 擴散場單次 Jacobi 迭代：純量版本
+void diffusionStepScalar(const float *src, float *dst, const float *mask, const float *source, float decay);
+
+#ifdef DIFFUSION_SIMD
+// 擴散場單次 Jacobi 迭代：SSE 版本
+void diffusionStepSse(const float *src, float *dst, const float *mask, const float *source, float decay);
+
+// 擴散場單次 Jacobi 迭代：AVX2 版本
+void diffusionStepAvx2(const float *src, float *dst, const float *mask, const float *source, float decay);
+#endif
+
+// 依據 CPU 支援的指令集選擇擴散核心
+DiffusionKernel selectDiffusionKernel();
+
+// 格子掃描核心：純量版本
+int countCellsScalar(const uint8_t *cells, int size, uint8_t value);
+int findCellScalar(const uint8_t *cells, int size, uint8_t value);
+void maskCellsScalar(const uint8_t *cells, int size, uint8_t value, uint64_t *bits);
+
+#ifdef CELL_SCAN_SIMD
+// 格子掃描核心：SSE2 版本，一次比較 16 格
+int countCellsSse2(const uint8_t *cells, int size, uint8_t value);
+int findCellSse2(const uint8_t *cells, int size, uint8_t value);
+void maskCellsSse2(const uint8_t *cells, int size, uint8_t value, uint64_t *bits);
+
+// 格子掃描核心：AVX2 版本，一次比較 32 格
+int countCellsAvx2(const uint8_t *cells, int size, uint8_t value);
+int findCellAvx2(const uint8_t *cells, int size, uint8_t value);
+void maskCellsAvx2(const uint8_t *cells, int size, uint8_t value, uint64_t *bits);
+
+// 格子掃描核心：AVX-512 (BW) 版本，一次比較 64 格
+int countCellsAvx512(const uint8_t *cells, int size, uint8_t value);
+int findCellAvx512(const uint8_t *cells, int size, uint8_t value);
+void maskCellsAvx512(const uint8_t *cells, int size, uint8_t value, uint64_t *bits);
+#endif
+
+// 依據 CPU 支援的指令集選擇格子掃描核心
+CellScanKernels selectCellScanKernels();
+
+// 取出位元遮罩中從第 start 位元開始的 count 個位元，count 不超過 63
+uint64_t cellMaskBits(const uint64_t *bits, int start, int count);
+
+// 遊戲場線性索引對應的座標
+Location fieldLocation(int cell);
+
+// 擴散場中 (row, col) 的索引
+int diffusionIndex(int row, int col);
+
+// 依據牆壁重建擴散場的可走遮罩
+void buildDiffusionMask(GameSession &session, GameField &field);
+
+// 清空擴散場
+void resetDiffusionField(GameSession &session);
+
+// 清空單一氣味場
+void resetScentField(ScentField &scent);
+
+// 清除上回合的氣味來源
+void clearScentSources(ScentField &scent);
+
+// 在 (row, col) 放置氣味來源
+void addScentSource(ScentField &scent, int row, int col, float strength);
+
+// 對氣味場進行數次擴散迭代
+void diffuseScent(GameSession &session, ScentField &scent);
+
+// 放置資源與喪屍的氣味來源，並進行數次擴散迭代
+void updateDiffusionField(GameSession &session, GameField &field, const ZombieHorde &horde);
+
+// 擴散場生存者AI：往氣味最強的相鄰格子前進
+Direction diffusionAI(GameSession &session, GameField &field,
+                      EntityPointer player,
+                      const ZombieHorde &horde);
+
+// 初始化 Zobrist 雜湊用的亂數表
+void initZobristKeys();
+
+// 由目前遊戲狀態建立前瞻搜尋狀態
+SearchState makeSearchState(GameSession &session, GameField &field, EntityPointer player, const ZombieHorde &horde);
+
+// 判斷前瞻搜尋中該格是否還有資源
+bool searchHasResource(GameField &field, const SearchState &state, int row, int col);
+
+// 模擬喪屍AI的下一步：往目標曼哈頓距離最短的可走鄰格前進
+void modelZombieStep(GameField &field, int &row, int &col, Location target);
+
+// 前瞻搜尋的靜態評估
+double evaluateSearchState(GameSession &session, GameField &field, const SearchState &state);
+
+// expectimax 最大化節點 (生存者選擇方向)
+double expectimaxMaxNode(GameSession &session, GameField &field, const SearchState &state, int depth);
+
+// expectimax 機率節點 (喪屍依模型前進或停留)
+double expectimaxChanceNode(GameSession &session, GameField &field, const SearchState &state, int depth);
+
+// expectimax 前瞻搜尋生存者AI
+Direction expectimaxAI(GameSession &session, GameField &field,
+                       EntityPointer player,
+                       const ZombieHorde &horde);
+
+// 模擬喪屍AI下一步 (MCTS 模擬狀態版本)
+void modelZombieStep(const SimState &state, int &row, int &col, Location target);
+
+// 由目前遊戲狀態建立 MCTS 模擬狀態
+SimState makeSimState(GameSession &session, GameField &field, EntityPointer player, const ZombieHorde &horde);
+
+// 在模擬狀態中隨機挑選不是牆也沒有喪屍的格子
+int simRandomFreeCell(const SimState &state, std::mt19937 &rng, bool avoidPlayer);
+
+// 依照 playGame 的順序模擬一個回合 (movePlayer、moveZombie、addZombie、playerCollectResource、IsGameOver)
+void simStep(SimState &state, Direction playerDirect, std::mt19937 &rng);
+
+// 模擬回合中的隨機生存者策略：隨機選擇不會撞牆或撞到喪屍的方向
+Direction simRolloutDirect(const SimState &state, std::mt19937 &rng);
+
+// 模擬狀態中生存者到最近資源的曼哈頓距離
+int simNearestResource(const SimState &state);
+
+// 單一執行緒的 MCTS 搜尋，直到時間截止或達到模擬次數上限 (0 表示不限)
+MctsResult runMctsWorker(const SimState &root, unsigned seed, std::chrono::steady_clock::time_point deadline,
+                         long long rolloutLimit);
+
+// 多執行緒 MCTS 生存者AI (根平行化)
+Direction mctsAI(GameSession &session, GameField &field,
+                 EntityPointer player,
+                 const ZombieHorde &horde);
+
+// 將 16 位元整數的位元分散到偶數位元，用於計算 Morton 索引
+uint32_t spreadMortonBits(uint32_t value);
+
+// 建立指定排列方式的大型地圖，依 walkable (列優先) 填入格子
+template<typename Layout>
+void buildLayoutGrid(LayoutGrid<Layout> &grid, const std::vector<uint8_t> &walkable, int side);
+
+// 大型地圖中該格是否可走，超出地圖視為不可走
+template<typename Layout>
+bool isGridWalkable(const LayoutGrid<Layout> &grid, int row, int col);
+
+// 從 start 對大型地圖做四方向 BFS，distance 以相同排列方式存放步數，回傳展開的格子數
+// cache 不為 nullptr 時，記錄每次讀寫格子與步數的位址到快取模型
+template<typename Layout>
+long long gridBreadthFirst(const LayoutGrid<Layout> &grid, Location start, std::vector<int> &distance,
+                           CacheModel *cache);
+
+// 從 start 到 goal 對大型地圖做四方向 A*，distance 以相同排列方式存放起點到各格的步數，回傳展開的格子數
+// 找到路徑時 distance 在 goal 的值就是路徑長度，否則為 -1；cache 的用法與 gridBreadthFirst 相同
+template<typename Layout>
+long long gridAStar(const LayoutGrid<Layout> &grid, Location start, Location goal, std::vector<int> &distance,
+                    CacheModel *cache);
+
+// 清空快取模型
+void resetCacheModel(CacheModel &cache);
+
+// 記錄一次記憶體存取到快取模型
+void touchCacheModel(CacheModel &cache, const void *address);
+
+// 初始化無限地圖
+void initChunkedWorld(ChunkedWorld &world, uint64_t seed, size_t budget, const std::string &directory);
+
+// 區塊座標組成查表用的鍵值
+uint64_t chunkKey(int32_t chunkRow, int32_t chunkCol);
+
+// 世界座標所在的區塊座標 (向下取整)
+int32_t worldToChunk(int64_t coordinate);
+
+// 依世界種子與區塊座標生成區塊迷宮
+void generateWorldChunk(WorldChunk &chunk, uint64_t seed);
+
+// 區塊存檔的路徑
+std::string worldChunkPath(const ChunkedWorld &world, int32_t chunkRow, int32_t chunkCol);
+
+// 從磁碟讀回修改過的區塊，沒有存檔時回傳 false
+bool loadWorldChunk(const ChunkedWorld &world, WorldChunk &chunk);
+
+// 將修改過的區塊寫到磁碟，沒有設定資料夾時輸出警告，修改會遺失
+void saveWorldChunk(const ChunkedWorld &world, const WorldChunk &chunk);
+
+// 取得區塊，不在記憶體時讀檔或生成，超過上限時淘汰最久未用的區塊
+WorldChunk &fetchWorldChunk(ChunkedWorld &world, int32_t chunkRow, int32_t chunkCol);
+
+// 取得無限地圖上的格子
+uint8_t worldCell(ChunkedWorld &world, WorldLocation location);
+
+// 修改無限地圖上的格子
+void setWorldCell(ChunkedWorld &world, WorldLocation location, uint8_t value);
+
+// 以 A* 在無限地圖上搜尋路徑，可跨越區塊邊界，找不到或超過展開上限時回傳 false
+bool findWorldPath(ChunkedWorld &world, WorldLocation start, WorldLocation goal, std::vector<WorldLocation> &path);
+
+// 將無限地圖以 origin 為左上角的範圍複製到遊戲區域
+void copyWorldWindow(ChunkedWorld &world, WorldLocation origin, GameField &field);
+
+
+// 載入預設的遊戲場和障礙物
+void loadDefaultField(GameField &field);
+
+// 以下為所有遊戲共用、啟動後只會讀取的設定與表格，每局遊戲各自的狀態在 GameSession 中
+extern const int scorePerResource;             // 每一份資源可得分數
+extern const int zombieLodRange;               // 遠方喪屍的距離門檻
+extern const int zombieLodInterval;            // 遠方喪屍重新規劃的間隔
+extern const int aiTickBudget;                 // 每回合喪屍規劃的時間預算
+extern const char *aiModeNames[AI_MODE_COUNT]; // 生存者AI種類名稱
+
+extern int influenceKernel[INFLUENCE_KERNEL_SIZE][INFLUENCE_KERNEL_SIZE]; // 單一喪屍的影響核心
+extern DiffusionKernel diffusionStep;          // 執行時選擇的擴散核心
+extern CellScanKernels cellScan;               // 執行時選擇的格子掃描核心
+
+extern uint64_t zobristPlayer[GRID_SIDE * GRID_SIDE]; // 生存者在各格的雜湊值
+extern uint64_t zobristZombie[GRID_SIDE * GRID_SIDE]; // 喪屍在各格的雜湊值
+extern uint64_t zobristResource[GRID_SIDE * GRID_SIDE]; // 資源在各格的雜湊值，被收集時切換
+extern uint64_t zobristZombieTurn;             // 喪屍這回合會移動時切換的雜湊值
+
+// 以下樣板由核心與效能測試共用，定義需要放在標頭中
+
+// 周圍 3x3 有 count 面牆的格子的牆壁懲罰
+template<typename Rules>
+int rulesWallPenalty(const Rules &rules, int count) {
+    return count > rules.wallPenaltyThreshold() ? count * count * 5 : 0;
+}
+
+// 規則所定大小的遊戲場中 (row, col) 的索引
+template<typename Rules>
+int rulesCellIndex(const Rules &rules, int row, int col) {
+    return (row + 1) * rules.stride() + col + 1;
+}
+
+// 先算每格上下 3 列的牆數，再左右相加；遊戲場邊界外不算牆，所以跳過哨兵
+template<typename Rules>
+void buildRulesWallTable(const Rules &rules, const uint8_t *cells, int *wallCount, int *wallPenalty) {
+    const int side = rules.side();
+    const int stride = rules.stride();
+
+    for (int row = 0; row < side; row++) {
+        const uint8_t *center = cells + rulesCellIndex(rules, row, 0);
+        const uint8_t *above = row > 0 ? center - stride : nullptr;
+        const uint8_t *below = row < side - 1 ? center + stride : nullptr;
+        int left = 0;
+        int middle = (center[0] == WALL) + (above && above[0] == WALL) + (below && below[0] == WALL);
+
+        for (int col = 0; col < side; col++) {
+            int right = 0;
+            if (col < side - 1)
+                right = (center[col + 1] == WALL) + (above && above[col + 1] == WALL) +
+                        (below && below[col + 1] == WALL);
+
+            int count = left + middle + right;
+            wallCount[row * side + col] = count;
+            wallPenalty[row * side + col] = rulesWallPenalty(rules, count);
+            left = middle;
+            middle = right;
+        }
+    }
+}
+
+// 多來源 BFS，外圈的哨兵牆讓展開鄰格時不需要檢查邊界
+template<typename Rules>
+int rulesBreadthFirst(const Rules &rules, const uint8_t *cells, const int *sources, int sourceCount,
+                      int *distance, int *owner, int *queue) {
+    const int stride = rules.stride();
+    const int offsets[] = {-stride, stride, -1, 1};
+    int head = 0;
+    int tail = 0;
+
+    std::fill(distance, distance + stride * stride, -1);
+    for (int i = 0; i < sourceCount; i++) {
+        int cell = sources[i];
+        if (cells[cell] != WALL && distance[cell] < 0) {
+            distance[cell] = 0;
+            if (owner)
+                owner[cell] = i;
+            queue[tail++] = cell;
+        }
+    }
+
+    while (head < tail) {
+        int cell = queue[head++];
+        int next = distance[cell] + 1;
+        for (int offset: offsets) {
+            int neighbor = cell + offset;
+            if (cells[neighbor] != WALL && distance[neighbor] < 0) {
+                distance[neighbor] = next;
+                if (owner)
+                    owner[neighbor] = owner[cell];
+                queue[tail++] = neighbor;
+            }
+        }
+    }
+    return tail;
+}
+
+// 建立指定排列方式的大型地圖
+template<typename Layout>
+void buildLayoutGrid(LayoutGrid<Layout> &grid, const std::vector<uint8_t> &walkable, int side) {
+    grid.side = side;
+    grid.cells.assign(Layout::cellCount(side), 0);
+    for (int row = 0; row < side; row++) {
+        for (int col = 0; col < side; col++) {
+            grid.cells[Layout::index(row, col, side)] = walkable[int64_t(row) * side + col];
+        }
+    }
+}
+
+// 大型地圖中該格是否可走
+template<typename Layout>
+bool isGridWalkable(const LayoutGrid<Layout> &grid, int row, int col) {
+    if (row < 0 || row >= grid.side || col < 0 || col >= grid.side)
+        return false;
+    return grid.cells[Layout::index(row, col, grid.side)] != 0;
+}
+
+// 四方向 BFS，佇列存放 (row, col)，每次展開時依排列方式計算鄰格的索引
+template<typename Layout>
+long long gridBreadthFirst(const LayoutGrid<Layout> &grid, Location start, std::vector<int> &distance,
+                           CacheModel *cache) {
+    const int iDir[] = {1, 0, -1, 0};
+    const int jDir[] = {0, 1, 0, -1};
+    std::vector<Location> queue;
+    long long expanded = 0;
+
+    distance.assign(Layout::cellCount(grid.side), -1);
+    if (!isGridWalkable(grid, start.row, start.col))
+        return 0;
+    distance[Layout::index(start.row, start.col, grid.side)] = 0;
+    queue.push_back(start);
+
+    for (size_t head = 0; head < queue.size(); head++) {
+        Location current = queue[head];
+        int currentDistance = distance[Layout::index(current.row, current.col, grid.side)];
+        expanded++;
+
+        for (int i = 0; i < 4; i++) {
+            int row = current.row + iDir[i];
+            int col = current.col + jDir[i];
+            if (row < 0 || row >= grid.side || col < 0 || col >= grid.side)
+                continue;
+
+            int64_t cell = Layout::index(row, col, grid.side);
+            if (cache != nullptr) {
+                touchCacheModel(*cache, &grid.cells[cell]);
+                touchCacheModel(*cache, &distance[cell]);
+            }
+            if (grid.cells[cell] == 0 || distance[cell] != -1)
+                continue;
+            distance[cell] = currentDistance + 1;
+            queue.push_back({row, col});
+        }
+    }
+    return expanded;
+}
+
+// 四方向 A*，以曼哈頓距離為啟發函數，開放串列是以 (步數 + 啟發值) 排序的堆積，
+// 格子與步數都透過 Layout 的索引存取，所以和 BFS 一樣反映排列方式的區域性
+template<typename Layout>
+long long gridAStar(const LayoutGrid<Layout> &grid, Location start, Location goal, std::vector<int> &distance,
+                    CacheModel *cache) {
+    struct OpenNode {
+        int cost;
+        int step;
+        Location location;
+    };
+    auto worse = [](const OpenNode &a, const OpenNode &b) { return a.cost > b.cost; };
+    auto heuristic = [goal](int row, int col) { return std::abs(row - goal.row) + std::abs(col - goal.col); };
+    const int iDir[] = {1, 0, -1, 0};
+    const int jDir[] = {0, 1, 0, -1};
+    std::vector<OpenNode> open;
+    long long expanded = 0;
+
+    distance.assign(Layout::cellCount(grid.side), -1);
+    if (!isGridWalkable(grid, start.row, start.col) || !isGridWalkable(grid, goal.row, goal.col))
+        return 0;
+    distance[Layout::index(start.row, start.col, grid.side)] = 0;
+    open.push_back({heuristic(start.row, start.col), 0, start});
+
+    while (!open.empty()) {
+        std::pop_heap(open.begin(), open.end(), worse);
+        OpenNode current = open.back();
+        open.pop_back();
+        if (current.step != distance[Layout::index(current.location.row, current.location.col, grid.side)])
+            continue;
+        if (current.location.row == goal.row && current.location.col == goal.col)
+            break;
+        expanded++;
+
+        for (int i = 0; i < 4; i++) {
+            int row = current.location.row + iDir[i];
+            int col = current.location.col + jDir[i];
+            if (row < 0 || row >= grid.side || col < 0 || col >= grid.side)
+                continue;
+
+            int64_t cell = Layout::index(row, col, grid.side);
+            if (cache != nullptr) {
+                touchCacheModel(*cache, &grid.cells[cell]);
+                touchCacheModel(*cache, &distance[cell]);
+            }
+            if (grid.cells[cell] == 0 || (distance[cell] != -1 && distance[cell] <= current.step + 1))
+                continue;
+            distance[cell] = current.step + 1;
+            open.push_back({current.step + 1 + heuristic(row, col), current.step + 1, {row, col}});
+            std::push_heap(open.begin(), open.end(), worse);
+        }
+    }
+    return expanded;
+}
+
+#endif